@@ -0,0 +1,141 @@
+// 1000 concurrent pipelines, each summing numbers from 2000 lines of its own pipe
+// written by a producer thread in small chunks round-robin:
+// * thread per pipeline, blocking read() in a generator source and apply()
+// * co_apply() of all pipelines in a single thread with event_loop
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+#include "descend/co_apply.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace dd = descend;
+
+namespace {
+
+constexpr std::size_t pipelines = 1000;
+constexpr std::size_t lines = 2000;
+constexpr std::size_t lines_per_write = 50;
+
+struct pipes
+{
+    std::vector<int> read;
+    std::vector<int> write;
+
+    pipes()
+    {
+        for (std::size_t i = 0; i < pipelines; ++i) {
+            int fds[2];
+            if (::pipe(fds) != 0) {
+                throw std::runtime_error("pipe failed");
+            }
+            read.push_back(fds[0]);
+            write.push_back(fds[1]);
+        }
+    }
+
+    ~pipes()
+    {
+        for (const int fd : read) {
+            ::close(fd);
+        }
+    }
+
+    std::thread produce()
+    {
+        return std::thread([this] {
+            std::string chunk;
+            for (std::size_t line = 0; line < lines; line += lines_per_write) {
+                for (const int fd : write) {
+                    chunk.clear();
+                    for (std::size_t i = line; i < line + lines_per_write; ++i) {
+                        chunk += std::to_string(i) + "\n";
+                    }
+                    (void) ::write(fd, chunk.data(), chunk.size());
+                }
+            }
+            for (const int fd : write) {
+                ::close(fd);
+            }
+        });
+    }
+};
+
+int parse(std::string_view line)
+{
+    int value = 0;
+    std::from_chars(line.data(), line.data() + line.size(), value);
+    return value;
+}
+
+// blocking line source for apply()
+auto blocking_lines(const int fd)
+{
+    return dd::generator<std::string_view>([fd, buffer = std::string(), start = std::size_t{0}, size = std::size_t{0}] (auto output) mutable {
+        while (true) {
+            const std::size_t end = buffer.find('\n', start);
+            if (end != std::string::npos && end < size) {
+                std::move(output)(std::string_view(buffer.data() + start, end - start));
+                start = end + 1;
+                return true;
+            }
+            buffer.erase(0, start);
+            size -= start;
+            start = 0;
+            buffer.resize(size + 65536);
+            const ssize_t n = ::read(fd, buffer.data() + size, 65536);
+            if (n <= 0) {
+                return false;
+            }
+            size += static_cast<std::size_t>(n);
+        }
+    });
+}
+
+dd::task<void> sum_lines(dd::event_loop& loop, const int fd, long& sum)
+{
+    sum = co_await dd::co_apply(dd::async_lines(loop, fd), dd::transform(parse), dd::accumulate(0L));
+}
+
+} // namespace
+
+int main()
+{
+    bench::report("thread per pipeline, apply()", bench::measure_ms([&] {
+        pipes p;
+        std::vector<long> sums(pipelines);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < pipelines; ++i) {
+            threads.emplace_back([&, i] {
+                sums[i] = dd::apply(blocking_lines(p.read[i]), dd::transform(parse), dd::accumulate(0L));
+            });
+        }
+        std::thread producer = p.produce();
+        producer.join();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        bench::do_not_optimize(sums);
+    }, 3));
+
+    bench::report("one thread, co_apply() in event_loop", bench::measure_ms([&] {
+        pipes p;
+        std::vector<long> sums(pipelines);
+        dd::event_loop loop;
+        for (std::size_t i = 0; i < pipelines; ++i) {
+            loop.spawn(sum_lines(loop, p.read[i], sums[i]));
+        }
+        std::thread producer = p.produce();
+        loop.run();
+        producer.join();
+        bench::do_not_optimize(sums);
+    }, 3));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace bench {
+
+// Prevents compiler from optimizing away the computation producing 'value'
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs 'f' 'repetitions' times, returns the best time of a single run in milliseconds
+template <class F>
+double measure_ms(F&& f, const int repetitions = 5)
+{
+    double best = 0.0;
+    for (int i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto finish = std::chrono::steady_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(finish - start).count();
+        if (i == 0 || ms < best) {
+            best = ms;
+        }
+    }
+    return best;
+}
+
+inline void report(const std::string_view name, const double ms)
+{
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(10)
+              << std::fixed << std::setprecision(3) << ms << " ms\n";
+}
+
+} // namespace bench
@@ -0,0 +1,34 @@
+// Overhead of deadline() on a cheap chain: filter + sum of 50M integers with a budget that never expires,
+// the clock is read on every element or once per 'check_every' elements
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    using namespace std::chrono_literals;
+
+    std::vector<std::uint32_t> values(50'000'000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+    const auto odd = [] (std::uint32_t x) { return x % 2 == 1; };
+
+    bench::report("no deadline", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(values, dd::filter(odd), dd::accumulate(std::uint64_t{0})));
+    }));
+    for (const std::size_t check_every : {1, 64, 1024}) {
+        bench::report("deadline(1h, " + std::to_string(check_every) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(values, dd::deadline(1h, check_every), dd::filter(odd), dd::accumulate(std::uint64_t{0})));
+        }));
+    }
+}
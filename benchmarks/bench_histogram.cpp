@@ -0,0 +1,52 @@
+// histogram()/log_histogram() stages against hand-written for_each lambdas capturing count arrays:
+// * 32 explicit edges: std::upper_bound per element vs branchless search with batched increments
+// * log-linear latency histogram: element by element add() vs batched stage
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t count = 20'000'000;
+
+    std::mt19937_64 rng{42};
+    std::lognormal_distribution<double> latency_dist{8.0, 1.5};
+    std::vector<double> latencies(count);
+    for (auto& latency : latencies) {
+        latency = latency_dist(rng);
+    }
+
+    std::vector<double> edges;
+    for (int i = 0; i <= 32; ++i) {
+        edges.push_back(50.0 * i * i);
+    }
+
+    bench::report("edges: for_each + std::upper_bound", bench::measure_ms([&] {
+        std::vector<std::uint64_t> counts(edges.size() + 1);
+        dd::apply(latencies, dd::for_each([&] (double x) {
+            ++counts[static_cast<std::size_t>(std::upper_bound(edges.begin(), edges.end(), x) - edges.begin())];
+        }));
+        bench::do_not_optimize(counts.data());
+    }));
+    bench::report("edges: histogram(edges)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(latencies, dd::histogram(edges)));
+    }));
+
+    bench::report("log: for_each + add()", bench::measure_ms([&] {
+        dd::log_linear_histogram hist{1, 1e9, 3};
+        dd::apply(latencies, dd::for_each([&] (double x) { hist.add(x); }));
+        bench::do_not_optimize(hist);
+    }));
+    bench::report("log: log_histogram(1, 1e9, 3)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(latencies, dd::log_histogram(1, 1e9, 3)));
+    }));
+}
@@ -0,0 +1,88 @@
+// 4 producer threads push 1M events (64 endpoints) into one per-endpoint latency aggregation:
+// * shared std::unordered_map guarded by std::mutex, updated by every producer
+// * ingestion() with map_group_by, producers only enqueue, the consumer thread aggregates
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+#include "descend/ingestion.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dd = descend;
+
+namespace {
+
+constexpr int producers = 4;
+constexpr int per_producer = 250'000;
+constexpr int endpoints = 64;
+
+struct Event
+{
+    const std::string* endpoint;
+    std::int64_t latency;
+};
+
+struct Totals
+{
+    std::int64_t count = 0;
+    std::int64_t sum = 0;
+};
+
+template <class F>
+void run_producers(F&& produce)
+{
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&produce, p] {
+            for (int i = 0; i < per_producer; ++i) {
+                produce(i % endpoints, std::int64_t{p + i % 100});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < endpoints; ++i) {
+        names.push_back("/api/v1/endpoint/" + std::to_string(i));
+    }
+
+    bench::report("mutex-guarded unordered_map", bench::measure_ms([&] {
+        std::mutex mutex;
+        std::unordered_map<std::string, Totals> totals;
+        run_producers([&] (int endpoint, std::int64_t latency) {
+            const std::lock_guard lock(mutex);
+            auto& t = totals[names[static_cast<std::size_t>(endpoint)]];
+            ++t.count;
+            t.sum += latency;
+        });
+        bench::do_not_optimize(totals);
+    }, 3));
+
+    bench::report("ingestion() + map_group_by", bench::measure_ms([&] {
+        auto pipeline = dd::ingestion<Event>({.capacity = 1 << 14},
+            dd::map_group_by<std::unordered_map>(
+                [] (const Event& e) -> const std::string& { return *e.endpoint; },
+                dd::transform(&Event::latency),
+                dd::accumulate(std::int64_t{0})),
+            dd::to<std::unordered_map>());
+        run_producers([&] (int endpoint, std::int64_t latency) {
+            pipeline.push(Event{&names[static_cast<std::size_t>(endpoint)], latency});
+        });
+        const auto totals = pipeline.finish();
+        bench::do_not_optimize(totals);
+    }, 3));
+}
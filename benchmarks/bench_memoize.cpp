@@ -0,0 +1,65 @@
+// Expensive pure function (std::regex classification of a string) on inputs with many repeats:
+// * transform(f)
+// * transform with std::unordered_map<std::string, R> memo in the lambda (unbounded)
+// * memoize_transform(f, capacity) with capacity above and below the number of distinct inputs
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t count = 1'000'000;
+    constexpr std::size_t distinct = 2'000;
+
+    std::vector<std::string> pool;
+    for (std::size_t i = 0; i < distinct; ++i) {
+        pool.push_back((i % 3 == 0 ? "user-" : i % 3 == 1 ? "host-" : "id") + std::to_string(i * 7919));
+    }
+    // skewed: small ids are much more frequent
+    std::mt19937_64 rng{42};
+    std::geometric_distribution<std::size_t> dist{0.005};
+    std::vector<std::string_view> input;
+    for (std::size_t i = 0; i < count; ++i) {
+        input.push_back(pool[dist(rng) % distinct]);
+    }
+
+    const std::regex pattern{"^(user|host)-[0-9]*[13579]$"};
+    const auto classify = [&pattern] (std::string_view s) {
+        return std::regex_match(s.begin(), s.end(), pattern) ? 1 : 0;
+    };
+
+    bench::report("transform(f)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(input, dd::transform(classify), dd::accumulate(0)));
+    }, 1));
+    bench::report("transform(f with unordered_map memo)", bench::measure_ms([&] {
+        std::unordered_map<std::string, int> memo;
+        bench::do_not_optimize(dd::apply(input, dd::transform([&] (std::string_view s) {
+            auto it = memo.find(std::string(s));
+            if (it == memo.end()) {
+                it = memo.emplace(std::string(s), classify(s)).first;
+            }
+            return it->second;
+        }), dd::accumulate(0)));
+    }));
+    for (const std::size_t capacity : {4096, 256}) {
+        dd::memoize_counters counters;
+        const double ms = bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(input, dd::memoize_transform(classify, capacity, std::ref(counters)), dd::accumulate(0)));
+        });
+        bench::report("memoize_transform(f, " + std::to_string(capacity) + "), hit rate "
+                + std::to_string(100 * counters.hits / (counters.hits + counters.misses)) + "%", ms);
+    }
+}
@@ -0,0 +1,76 @@
+// Binary file of 24-byte records (page cache is warm after the first repetition):
+// * full scan: fread() into std::vector vs mmap_records<T>() yielding records from the mapping
+// * 1% time range: where() checking every record vs where() with block_index skipping blocks
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+#include "descend/mmap_records.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dd = descend;
+
+namespace {
+
+struct Trade
+{
+    std::int64_t ts;
+    double price;
+    std::uint32_t qty;
+};
+
+} // namespace
+
+int main()
+{
+    constexpr std::size_t count = 8'000'000;
+    const std::string path = (std::filesystem::temp_directory_path() / "descend_bench_trades.bin").string();
+    const std::string index_path = path + ".ts";
+
+    {
+        std::mt19937_64 rng{42};
+        std::vector<Trade> trades(count);
+        std::int64_t ts = 0;
+        for (auto& trade : trades) {
+            ts += static_cast<std::int64_t>(rng() % 100);
+            trade = {ts, static_cast<double>(rng() % 10000) / 100, static_cast<std::uint32_t>(rng() % 1000)};
+        }
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(trades.data(), sizeof(Trade), trades.size(), file);
+        std::fclose(file);
+    }
+
+    bench::report("full: fread + vector", bench::measure_ms([&] {
+        std::vector<Trade> trades(std::filesystem::file_size(path) / sizeof(Trade));
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        bench::do_not_optimize(std::fread(trades.data(), sizeof(Trade), trades.size(), file));
+        std::fclose(file);
+        bench::do_not_optimize(dd::apply(trades, dd::transform(&Trade::qty), dd::accumulate(std::uint64_t{0})));
+    }));
+    bench::report("full: mmap_records", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(dd::mmap_records<Trade>(path), dd::transform(&Trade::qty), dd::accumulate(std::uint64_t{0})));
+    }));
+
+    const auto trades = dd::mmap_records<Trade>(path);
+    dd::block_index<std::int64_t>::build(trades.records(), &Trade::ts).save(index_path);
+    const auto index = dd::block_index<std::int64_t>::load(index_path);
+    const std::int64_t from = trades.records()[count / 2].ts;
+    const std::int64_t to = trades.records()[count / 2 + count / 100].ts;
+
+    bench::report("1% range: where() without index", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(trades.where(&Trade::ts, from, to), dd::transform(&Trade::qty), dd::accumulate(std::uint64_t{0})));
+    }));
+    bench::report("1% range: where() with block_index", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(trades.where(&Trade::ts, from, to, &index), dd::transform(&Trade::qty), dd::accumulate(std::uint64_t{0})));
+    }));
+
+    std::remove(index_path.c_str());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,84 @@
+// map_group_by with std::string keys vs owning_key<std::string> with std::string_view lookup.
+// Counts heap allocations made by each pipeline.
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+std::size_t allocation_count = 0;
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++allocation_count;
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace dd = descend;
+
+struct Record
+{
+    std::string endpoint;
+    int latency;
+};
+
+int main()
+{
+    constexpr std::size_t records_count = 1'000'000;
+    constexpr std::size_t keys_count = 1'000;
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<std::size_t> key_dist{0, keys_count - 1};
+    std::vector<Record> records;
+    records.reserve(records_count);
+    for (std::size_t i = 0; i < records_count; ++i) {
+        // long enough to not fit into small string buffer
+        records.push_back({"/api/v1/some/long/endpoint/" + std::to_string(key_dist(rng)), static_cast<int>(i % 100)});
+    }
+
+    const auto run = [&] (const std::string_view name, auto&& key_getter) {
+        std::size_t allocations = 0;
+        const double ms = bench::measure_ms([&] {
+            const std::size_t before = allocation_count;
+            auto result = dd::apply(
+                    records,
+                    dd::map_group_by<std::unordered_map>(
+                        key_getter,
+                        dd::transform(&Record::latency),
+                        dd::accumulate()),
+                    dd::count());
+            allocations = allocation_count - before;
+            bench::do_not_optimize(result);
+        });
+        bench::report(name, ms);
+        std::cout << "    allocations: " << allocations << '\n';
+    };
+
+    run("std::string key", [] (const Record& r) { return std::string(r.endpoint); });
+    run("owning_key<std::string>, string_view lookup",
+            dd::owning_key<std::string>([] (const Record& r) { return std::string_view{r.endpoint}; }));
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Expensive per-element function (rounds of hashing over a 4 KiB blob) followed by a cheap aggregation:
+// * transform(f)
+// * parallel_transform(f, workers) and parallel_transform_unordered(f, workers) for 1, 2, 4... hardware threads
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+#include "descend/stages/parallel_transform.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t count = 20'000;
+    constexpr std::size_t blob_size = 4096;
+
+    std::vector<std::vector<std::uint64_t>> blobs(count, std::vector<std::uint64_t>(blob_size / sizeof(std::uint64_t)));
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t j = 0; j < blobs[i].size(); ++j) {
+            blobs[i][j] = i * 1'000'003 + j;
+        }
+    }
+    // pointers are passed to the workers, blobs are not copied
+    std::vector<const std::vector<std::uint64_t>*> input;
+    for (const auto& blob : blobs) {
+        input.push_back(&blob);
+    }
+
+    const auto digest = [] (const std::vector<std::uint64_t>* blob) {
+        std::uint64_t h = 0;
+        for (int round = 0; round < 8; ++round) {
+            for (const std::uint64_t word : *blob) {
+                h = dd::detail::splitmix64::mix(h ^ word);
+            }
+        }
+        return h;
+    };
+
+    bench::report("transform(f)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(input, dd::transform(digest), dd::accumulate(std::uint64_t{0})));
+    }));
+
+    const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t workers = 1; workers <= threads; workers *= 2) {
+        bench::report("parallel_transform(f, " + std::to_string(workers) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(input, dd::parallel_transform(digest, workers), dd::accumulate(std::uint64_t{0})));
+        }));
+        bench::report("parallel_transform_unordered(f, " + std::to_string(workers) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(input, dd::parallel_transform_unordered(digest, workers), dd::accumulate(std::uint64_t{0})));
+        }));
+    }
+}
@@ -0,0 +1,79 @@
+// parse<T>() stages against transform() with std::from_chars (as in examples/basic_usage.cpp) + unwrap_error_or():
+// * fixed-width 8-digit integer fields (zero padded)
+// * variable-width integers of up to 10 digits
+// * collecting into std::vector: parse<T>() + unwrap_error_or() vs parse_batch<T>()
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace dd = descend;
+
+namespace {
+
+dd::error_or<std::uint32_t> parse_from_chars(const std::string_view str) noexcept
+{
+    std::uint32_t value;
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || ptr != str.data() + str.size()) {
+        return dd::error_or<std::uint32_t>{dd::in_place_error, std::make_error_code(std::errc::invalid_argument)};
+    }
+    return dd::error_or<std::uint32_t>{dd::in_place_value, value};
+}
+
+void run(const std::string& name, const std::vector<std::string_view>& fields)
+{
+    bench::report(name + ": transform(from_chars), sum", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(fields,
+                dd::transform(&parse_from_chars), dd::unwrap_error_or(), dd::accumulate(std::uint64_t{0})));
+    }));
+    bench::report(name + ": parse<uint32_t>(), sum", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(fields,
+                dd::parse<std::uint32_t>(), dd::unwrap_error_or(), dd::accumulate(std::uint64_t{0})));
+    }));
+    bench::report(name + ": parse<uint32_t>(), to<vector>", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(fields,
+                dd::parse<std::uint32_t>(), dd::unwrap_error_or(), dd::to<std::vector>()));
+    }));
+    bench::report(name + ": parse_batch<uint32_t>()", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(fields, dd::parse_batch<std::uint32_t>()));
+    }));
+}
+
+} // namespace
+
+int main()
+{
+    constexpr std::size_t count = 10'000'000;
+
+    std::mt19937_64 rng{42};
+    std::string fixed_text;
+    std::string variable_text;
+    std::vector<std::size_t> variable_offsets;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string digits = std::to_string(rng() % 100'000'000);
+        fixed_text += std::string(8 - digits.size(), '0') + digits;
+        variable_offsets.push_back(variable_text.size());
+        variable_text += std::to_string(static_cast<std::uint32_t>(rng() >> (rng() % 32 + 32)));
+    }
+    variable_offsets.push_back(variable_text.size());
+
+    std::vector<std::string_view> fixed;
+    std::vector<std::string_view> variable;
+    for (std::size_t i = 0; i < count; ++i) {
+        fixed.push_back(std::string_view(fixed_text).substr(i * 8, 8));
+        variable.push_back(std::string_view(variable_text).substr(variable_offsets[i], variable_offsets[i + 1] - variable_offsets[i]));
+    }
+
+    run("fixed 8 digits", fixed);
+    run("up to 10 digits", variable);
+}
@@ -0,0 +1,92 @@
+// Random indirection (DRAM latency bound) with and without prefetch() stage:
+// * sum over std::vector<const Node*> pointing to shuffled nodes
+// * the same with one more dependent load (node->next->value)
+// * lookups into a large table by random indices
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dd = descend;
+
+namespace {
+
+struct Node
+{
+    std::int64_t value;
+    const Node* next;
+    char payload[48];
+};
+
+} // namespace
+
+int main()
+{
+    constexpr std::size_t nodes_count = 1 << 21;  // 128 MiB of nodes
+    constexpr std::size_t table_size = 1 << 25;   // 128 MiB table
+    constexpr std::size_t lookups_count = 1 << 22;
+
+    std::mt19937_64 rng{42};
+
+    std::vector<Node> nodes(nodes_count);
+    std::vector<const Node*> pointers(nodes_count);
+    for (std::size_t i = 0; i < nodes_count; ++i) {
+        nodes[i].value = static_cast<std::int64_t>(i);
+        pointers[i] = &nodes[i];
+    }
+    std::shuffle(pointers.begin(), pointers.end(), rng);
+    for (std::size_t i = 0; i < nodes_count; ++i) {
+        nodes[i].next = pointers[(i * 7919) % nodes_count];
+    }
+
+    std::vector<std::uint32_t> table(table_size);
+    for (std::size_t i = 0; i < table_size; ++i) {
+        table[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+    std::uniform_int_distribution<std::uint32_t> index_dist{0, table_size - 1};
+    std::vector<std::uint32_t> indices(lookups_count);
+    for (auto& index : indices) {
+        index = index_dist(rng);
+    }
+
+    const auto node_value = [] (const Node* node) { return node->value; };
+    const auto next_value = [] (const Node* node) { return node->next->value; };
+    const auto table_lookup = [&table] (std::uint32_t i) { return std::uint64_t{table[i]}; };
+    const auto table_address = [&table] (std::uint32_t i) { return &table[i]; };
+
+    bench::report("pointers: no prefetch", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(pointers, dd::transform(node_value), dd::accumulate()));
+    }));
+    for (const std::size_t distance : {4, 16, 64}) {
+        bench::report("pointers: prefetch(" + std::to_string(distance) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(pointers, dd::prefetch(distance), dd::transform(node_value), dd::accumulate()));
+        }));
+    }
+
+    // the second load depends on the first one, prefetching the first level shortens the chain
+    bench::report("pointers->next: no prefetch", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(pointers, dd::transform(next_value), dd::accumulate()));
+    }));
+    for (const std::size_t distance : {4, 16, 64}) {
+        bench::report("pointers->next: prefetch(" + std::to_string(distance) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(pointers, dd::prefetch(distance), dd::transform(next_value), dd::accumulate()));
+        }));
+    }
+
+    bench::report("table lookups: no prefetch", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(indices, dd::transform(table_lookup), dd::accumulate()));
+    }));
+    for (const std::size_t distance : {4, 16, 64}) {
+        bench::report("table lookups: prefetch(" + std::to_string(distance) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(indices, dd::prefetch(distance, table_address),
+                                             dd::transform(table_lookup), dd::accumulate()));
+        }));
+    }
+}
@@ -0,0 +1,85 @@
+// quantiles() sketch against exact quantiles (collect + sort):
+// * accuracy: true rank of returned p50/p95/p99 for different accuracy settings
+// * throughput over the whole input
+// * per group (map_group_by with 1000 keys)
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t count = 10'000'000;
+    constexpr std::uint32_t groups_count = 1000;
+
+    std::mt19937_64 rng{42};
+    std::lognormal_distribution<double> latency_dist{3.0, 1.0};
+    std::uniform_int_distribution<std::uint32_t> group_dist{0, groups_count - 1};
+
+    struct Event
+    {
+        std::uint32_t group;
+        double latency;
+    };
+    std::vector<Event> events(count);
+    for (auto& event : events) {
+        event = {group_dist(rng), latency_dist(rng)};
+    }
+    const auto latency = [] (const Event& e) { return e.latency; };
+    const auto group = [] (const Event& e) { return e.group; };
+
+    std::vector<double> sorted = dd::apply(events, dd::transform(latency), dd::to<std::vector>());
+    std::sort(sorted.begin(), sorted.end());
+    const auto true_rank = [&sorted] (const double value) {
+        const auto it = std::lower_bound(sorted.begin(), sorted.end(), value);
+        return static_cast<double>(it - sorted.begin()) / static_cast<double>(sorted.size());
+    };
+
+    const double ranks[] = {0.5, 0.95, 0.99};
+    for (const double accuracy : {0.05, 0.01, 0.002}) {
+        const auto result = dd::apply(events, dd::transform(latency), dd::quantiles({0.5, 0.95, 0.99}, accuracy));
+        const auto sketch = dd::apply(events, dd::transform(latency), dd::quantile_sketch(accuracy));
+        std::cout << "accuracy " << accuracy << ": rank error";
+        for (std::size_t i = 0; i < 3; ++i) {
+            std::cout << " p" << ranks[i] * 100 << " " << std::abs(true_rank(result[i]) - ranks[i]);
+        }
+        std::cout << ", retained " << sketch.retained() << " of " << count << "\n";
+    }
+
+    bench::report("exact: to<vector> + sort", bench::measure_ms([&] {
+        auto values = dd::apply(events, dd::transform(latency), dd::to<std::vector>());
+        std::sort(values.begin(), values.end());
+        bench::do_not_optimize(values[values.size() / 2]);
+    }, 3));
+    for (const double accuracy : {0.05, 0.01, 0.002}) {
+        bench::report("quantiles(accuracy " + std::to_string(accuracy).substr(0, 5) + ")", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(events, dd::transform(latency), dd::quantiles({0.5, 0.95, 0.99}, accuracy)));
+        }, 3));
+    }
+
+    bench::report("per group exact: vectors + sort", bench::measure_ms([&] {
+        auto grouped = dd::apply(events, dd::map_group_by<std::unordered_map>(group, dd::transform(latency), dd::to<std::vector>()),
+                                 dd::make_pair(), dd::to<std::vector>());
+        for (auto& [key, values] : grouped) {
+            std::sort(values.begin(), values.end());
+            bench::do_not_optimize(values[values.size() / 2]);
+        }
+    }, 3));
+    bench::report("per group quantiles(accuracy 0.01)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(events,
+            dd::map_group_by<std::unordered_map>(group, dd::transform(latency), dd::quantiles({0.5, 0.95, 0.99})),
+            dd::make_pair(), dd::to<std::vector>()));
+    }, 3));
+}
@@ -0,0 +1,64 @@
+// Scalar pipelines with the default passing (references) vs DESCEND_PASS_SMALL_BY_VALUE.
+// Built twice at -O2: bench_small_by_value (default) and bench_small_by_value_on (policy enabled),
+// run both and compare timings.
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t size = 10'000'000;
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> int_dist{-1000, 1000};
+    std::uniform_real_distribution<double> double_dist{0.0, 1.0};
+    std::vector<int> ints(size);
+    std::vector<double> doubles(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        ints[i] = int_dist(rng);
+        doubles[i] = double_dist(rng);
+    }
+
+    std::cout << "small values passed by " << (dd::detail::pass_small_by_value ? "value" : "reference") << "\n";
+
+    bench::report("enumerate/filter/transform/accumulate ints", bench::measure_ms([&] {
+        const auto result = dd::apply(
+            ints,
+            dd::enumerate<std::int64_t>(),
+            dd::filter([] (std::int64_t i, int x) { return (i & 3) != 0 && x > 0; }),
+            dd::transform([] (std::int64_t i, int x) { return i * x; }),
+            dd::accumulate(std::int64_t{0})
+        );
+        bench::do_not_optimize(result);
+    }));
+
+    bench::report("zip_result/transform_arg/accumulate doubles", bench::measure_ms([&] {
+        const auto result = dd::apply(
+            doubles,
+            dd::zip_result([] (double x) { return x * x; }),
+            dd::transform_arg<1>([] (double sq) { return sq + 1.0; }),
+            dd::transform([] (double x, double y) { return x * y; }),
+            dd::accumulate(0.0)
+        );
+        bench::do_not_optimize(result);
+    }));
+
+    bench::report("columns/filter/min_max ints x doubles", bench::measure_ms([&] {
+        const auto result = dd::apply(
+            dd::columns(ints, doubles),
+            dd::filter([] (int x, double) { return x % 3 != 0; }),
+            dd::transform([] (int x, double y) { return x * y; }),
+            dd::min_max()
+        );
+        bench::do_not_optimize(result);
+    }));
+}
@@ -0,0 +1,60 @@
+// stats() and sum_precise() against accumulate(0.0) and naive sum of squares:
+// * accuracy on values with large mean and small variance
+// * throughput over std::vector<double> (random access path) and a generated stream (element by element)
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t count = 20'000'000;
+
+    std::mt19937_64 rng{42};
+    std::normal_distribution<double> dist{1e9, 1.0}; // true variance is 1
+    std::vector<double> values(count);
+    for (auto& value : values) {
+        value = dist(rng);
+    }
+
+    {
+        const double sum = dd::apply(values, dd::accumulate(0.0));
+        const double sum_squares = dd::apply(values, dd::transform([] (double x) { return x * x; }), dd::accumulate(0.0));
+        const double n = static_cast<double>(count);
+        const double naive_variance = sum_squares / n - (sum / n) * (sum / n);
+        const auto s = dd::apply(values, dd::stats());
+        std::cout << "variance (true ~1): naive sum of squares " << naive_variance << ", stats() " << s.variance() << "\n";
+
+        // exact sum of 0.1 repeated is 0.1 * count up to one rounding
+        const std::vector<double> tenths(count, 0.1);
+        std::cout << "sum of 0.1 x " << count << " error: accumulate(0.0) "
+                  << std::abs(dd::apply(tenths, dd::accumulate(0.0)) - 0.1 * n)
+                  << ", sum_precise() " << std::abs(dd::apply(tenths, dd::sum_precise()) - 0.1 * n) << "\n";
+    }
+
+    bench::report("vector: accumulate(0.0)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(values, dd::accumulate(0.0)));
+    }));
+    bench::report("vector: sum_precise()", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(values, dd::sum_precise()));
+    }));
+    bench::report("vector: stats()", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(values, dd::stats()));
+    }));
+    bench::report("vector: stats<4>()", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(values, dd::stats<4>()));
+    }));
+
+    const auto stream = [&values] { return dd::apply(dd::iota(std::size_t{0}, values.size()), dd::transform([&values] (std::size_t i) { return values[i]; }), dd::stats()); };
+    bench::report("stream: stats() (Welford)", bench::measure_ms([&] {
+        bench::do_not_optimize(stream());
+    }));
+}
@@ -0,0 +1,77 @@
+// top_frequent(k) against exact map_group_by(count()) + partial sort of all groups,
+// on Zipf-distributed keys with many distinct values
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dd = descend;
+
+int main()
+{
+    constexpr std::size_t count = 20'000'000;
+    constexpr std::size_t distinct = 2'000'000;
+    constexpr std::size_t k = 10;
+
+    // Zipf(1.0) by inverse transform over the precomputed CDF
+    std::vector<double> cdf(distinct);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < distinct; ++i) {
+        sum += 1.0 / static_cast<double>(i + 1);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 rng{42};
+    std::uniform_real_distribution<double> uniform{0.0, sum};
+    std::vector<std::uint64_t> keys(count);
+    for (auto& key : keys) {
+        const auto rank = static_cast<std::uint64_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+        key = rank * 0x9e3779b97f4a7c15ULL; // spread keys over 64 bits
+    }
+
+    const auto exact_top = [&keys] {
+        auto groups = dd::apply(keys, dd::map_group_by<std::unordered_map>(std::identity{}, dd::count()),
+                                dd::make_pair(), dd::to<std::vector>());
+        std::partial_sort(groups.begin(), groups.begin() + k, groups.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+        });
+        groups.resize(k);
+        return groups;
+    };
+
+    const auto exact = exact_top();
+    for (const std::size_t width : {1024, 4096, 16384}) {
+        const auto top = dd::apply(keys, dd::top_frequent(k, width, 4));
+        std::size_t found = 0;
+        double max_overestimate = 0.0;
+        for (const auto& [key, n] : exact) {
+            const auto it = std::find_if(top.begin(), top.end(), [key] (const auto& p) { return p.first == key; });
+            if (it != top.end()) {
+                ++found;
+                max_overestimate = std::max(max_overestimate, static_cast<double>(it->second - n) / static_cast<double>(n));
+            }
+        }
+        std::cout << "width " << width << ": " << found << " of top " << k << " found, max relative overestimate "
+                  << max_overestimate << "\n";
+    }
+
+    bench::report("exact: map_group_by(count) + partial_sort", bench::measure_ms([&] {
+        bench::do_not_optimize(exact_top());
+    }, 3));
+    for (const std::size_t width : {1024, 4096, 16384}) {
+        bench::report("top_frequent(10, " + std::to_string(width) + ", 4)", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(keys, dd::top_frequent(k, width, 4)));
+        }, 3));
+    }
+}
@@ -0,0 +1,105 @@
+// Lookups of random keys in a hash table much larger than cache, shared with other threads under a mutex:
+// * transform(lookup) - lock per element, cache misses of lookups don't overlap across the lock
+// * transform_batch(n, bulk_lookup) - lock per batch, slots of the whole batch are prefetched before the first probe
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dd = descend;
+
+namespace {
+
+// Open addressing table with linear probing, key 0 is empty
+struct table
+{
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint64_t> values;
+    std::size_t mask;
+
+    explicit table(const std::size_t capacity)
+        : keys(capacity), values(capacity), mask(capacity - 1)
+    {}
+
+    static std::uint64_t hash(const std::uint64_t key) noexcept
+    { return dd::detail::splitmix64::mix(key); }
+
+    void insert(const std::uint64_t key, const std::uint64_t value)
+    {
+        std::size_t i = hash(key) & mask;
+        while (keys[i] != 0 && keys[i] != key) {
+            i = (i + 1) & mask;
+        }
+        keys[i] = key;
+        values[i] = value;
+    }
+
+    std::uint64_t find_from(std::size_t i, const std::uint64_t key) const noexcept
+    {
+        while (keys[i] != 0) {
+            if (keys[i] == key) {
+                return values[i];
+            }
+            i = (i + 1) & mask;
+        }
+        return 0;
+    }
+
+    std::uint64_t find(const std::uint64_t key) const noexcept
+    { return find_from(hash(key) & mask, key); }
+};
+
+} // namespace
+
+int main()
+{
+    constexpr std::size_t count = 4'000'000;
+    constexpr std::size_t size = 4'000'000;
+
+    table t{std::size_t{1} << 23}; // 128 MiB of keys and values
+    std::mt19937_64 rng{42};
+    std::vector<std::uint64_t> stored;
+    for (std::size_t i = 0; i < size; ++i) {
+        stored.push_back(rng() | 1);
+        t.insert(stored.back(), i);
+    }
+    std::vector<std::uint64_t> input;
+    for (std::size_t i = 0; i < count; ++i) {
+        input.push_back(stored[rng() % size]);
+    }
+
+    std::mutex mutex;
+
+    bench::report("transform(lookup)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(input, dd::transform([&t, &mutex] (std::uint64_t key) {
+            const std::lock_guard lock{mutex};
+            return t.find(key);
+        }), dd::accumulate(std::uint64_t{0})));
+    }));
+
+    const auto bulk_lookup = [&t, &mutex] (std::span<const std::uint64_t> keys, std::span<std::uint64_t> out) {
+        const std::lock_guard lock{mutex};
+        std::size_t slots[256];
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            slots[i] = table::hash(keys[i]) & t.mask;
+            dd::detail::stages::prefetch_address(&t.keys[slots[i]]);
+            dd::detail::stages::prefetch_address(&t.values[slots[i]]);
+        }
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            out[i] = t.find_from(slots[i], keys[i]);
+        }
+    };
+    for (const std::size_t batch_size : {16, 64, 256}) {
+        bench::report("transform_batch(" + std::to_string(batch_size) + ", bulk_lookup)", bench::measure_ms([&] {
+            bench::do_not_optimize(dd::apply(input, dd::transform_batch(batch_size, bulk_lookup), dd::accumulate(std::uint64_t{0})));
+        }));
+    }
+}
@@ -0,0 +1,93 @@
+// Counting lines of a 256 MiB file read in 1 MiB blocks, with the page cache dropped for the file
+// (cold, posix_fadvise(POSIX_FADV_DONTNEED)) and with the file cached (warm):
+// * buffered read() loop on the chain thread, as a generator source
+// * uring_file() with io_uring, 8 reads in flight
+// * uring_file() with pread() thread reading ahead
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+#include "descend/uring_file.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace dd = descend;
+
+namespace {
+
+void drop_cache(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+} // namespace
+
+int main()
+{
+    constexpr std::size_t file_size = std::size_t{256} << 20;
+    constexpr std::size_t block_size = std::size_t{1} << 20;
+    const std::string path = (std::filesystem::temp_directory_path() / "descend_bench_uring.txt").string();
+    {
+        std::string content;
+        for (std::size_t i = 0; content.size() < file_size; ++i) {
+            content += "event " + std::to_string(i * 7919) + " status=ok\n";
+        }
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(content.data(), 1, content.size(), file);
+        std::fclose(file);
+    }
+
+    const auto count_lines = [] (std::span<const std::byte> block) {
+        return static_cast<std::size_t>(std::count(block.begin(), block.end(), std::byte{'\n'}));
+    };
+
+    const auto read_loop = [&] {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        std::vector<std::byte> buffer(block_size);
+        const auto result = dd::apply(dd::generator<std::span<const std::byte>>([&] (auto output) {
+            const ssize_t n = ::read(fd, buffer.data(), buffer.size());
+            if (n <= 0) {
+                return false;
+            }
+            std::move(output)(std::span<const std::byte>(buffer.data(), static_cast<std::size_t>(n)));
+            return true;
+        }), dd::transform(count_lines), dd::accumulate(std::size_t{0}));
+        ::close(fd);
+        return result;
+    };
+    const auto uring_read = [&] (const dd::read_backend backend) {
+        return dd::apply(dd::uring_file(path, block_size, 8, backend), dd::transform(count_lines), dd::accumulate(std::size_t{0}));
+    };
+
+    for (const bool cold : {true, false}) {
+        const std::string suffix = cold ? ", cold" : ", warm";
+        const auto measure = [&] (auto&& f) {
+            return bench::measure_ms([&] {
+                if (cold) {
+                    drop_cache(path);
+                }
+                bench::do_not_optimize(f());
+            }, 3);
+        };
+        bench::report("read() loop" + suffix, measure(read_loop));
+        if (dd::uring_file_source::io_uring_available()) {
+            bench::report("uring_file(io_uring)" + suffix, measure([&] { return uring_read(dd::read_backend::io_uring); }));
+        }
+        bench::report("uring_file(pread_thread)" + suffix, measure([&] { return uring_read(dd::read_backend::pread_thread); }));
+    }
+
+    std::remove(path.c_str());
+}
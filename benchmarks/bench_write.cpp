@@ -0,0 +1,71 @@
+// Writing pipeline output into a file:
+// * text lines "<int> <double>": for_each with std::ofstream << vs write_lines()
+// * 24-byte binary records: for_each with std::ofstream::write vs write_records<T>() (and with O_DIRECT)
+
+#include "bench_common.hpp"
+
+#include "descend/descend.hpp"
+#include "descend/stages/write.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dd = descend;
+
+namespace {
+
+struct Trade
+{
+    std::int64_t ts;
+    double price;
+    std::uint32_t qty;
+};
+
+} // namespace
+
+int main()
+{
+    constexpr std::size_t count = 5'000'000;
+    const std::string path = (std::filesystem::temp_directory_path() / "descend_bench_write.out").string();
+
+    std::mt19937_64 rng{42};
+    std::vector<std::int64_t> ids(count);
+    std::vector<double> prices(count);
+    std::vector<Trade> trades(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ids[i] = static_cast<std::int64_t>(rng() % 1'000'000'000);
+        prices[i] = static_cast<double>(rng() % 1'000'000) / 100;
+        trades[i] = {ids[i], prices[i], static_cast<std::uint32_t>(i)};
+    }
+
+    bench::report("lines: for_each + std::ofstream <<", bench::measure_ms([&] {
+        std::ofstream out(path);
+        dd::apply(dd::columns(ids, prices), dd::for_each([&out] (std::int64_t id, double price) {
+            out << id << ' ' << price << '\n';
+        }));
+    }));
+    bench::report("lines: write_lines(path)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(dd::columns(ids, prices), dd::write_lines(path)));
+    }));
+
+    bench::report("records: for_each + std::ofstream::write", bench::measure_ms([&] {
+        std::ofstream out(path, std::ios::binary);
+        dd::apply(trades, dd::for_each([&out] (const Trade& t) {
+            out.write(reinterpret_cast<const char*>(&t), sizeof(t));
+        }));
+    }));
+    bench::report("records: write_records<T>(path)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(trades, dd::write_records<Trade>(path)));
+    }));
+    bench::report("records: write_records<T>(path, direct)", bench::measure_ms([&] {
+        bench::do_not_optimize(dd::apply(trades, dd::write_records<Trade>(path, {.direct = true})));
+    }));
+
+    std::remove(path.c_str());
+}
@@ -37,8 +37,8 @@ struct args : std::tuple<Ts...>
 
     template <class Tuple>
         requires std::is_constructible_v<tuple_type, Tuple>
-    constexpr args(Tuple&& tuple) noexcept(std::is_nothrow_constructible_v<tuple_type, Tuple>)
-        : tuple_type((Tuple&&) tuple)
+    constexpr args(Tuple&& t) noexcept(std::is_nothrow_constructible_v<tuple_type, Tuple>)
+        : tuple_type((Tuple&&) t)
     { }
 
     constexpr decltype(auto) as_tuple() & noexcept
@@ -53,6 +53,38 @@ struct args : std::tuple<Ts...>
 };
 
 
+// Small trivially copyable types fit into (at most two) registers and are cheaper to copy than to refer to
+template <class T>
+inline constexpr bool is_small_trivially_copyable_v =
+        std::is_trivially_copyable_v<T> && !std::is_volatile_v<T> && sizeof(T) <= 16;
+
+// Type used to pass T between stages when DESCEND_PASS_SMALL_BY_VALUE is defined:
+//   const T&, T&&, const T&& -> T   for small trivially copyable T
+//   T&                       -> T&  mutable references are kept, writes should reach the source
+//   args<Ts...>              -> args<small_by_value_t<Ts>...>
+// Everything else is kept as is.
+template <class T>
+struct small_by_value
+{
+    using type = T;
+};
+template <class T>
+    requires (   is_small_trivially_copyable_v<std::remove_cvref_t<T>>
+              && !is_specialization_of_v<args, std::remove_cvref_t<T>>
+              && (!std::is_lvalue_reference_v<T> || std::is_const_v<std::remove_reference_t<T>>))
+struct small_by_value<T>
+{
+    using type = std::remove_cvref_t<T>;
+};
+template <class... Ts>
+struct small_by_value<args<Ts...>>
+{
+    using type = args<typename small_by_value<Ts>::type...>;
+};
+template <class T>
+using small_by_value_t = typename small_by_value<T>::type;
+
+
 template <class Tuple>
 using make_index_sequence_for_tuple = std::make_index_sequence<std::tuple_size_v<Tuple>>;
 
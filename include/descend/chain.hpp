@@ -1,5 +1,6 @@
 #pragma once
 
+#include "descend/args.hpp"
 #include "descend/compose.hpp"
 #include "descend/finalize.hpp"
 #include "descend/generator.hpp"
@@ -23,6 +24,28 @@ struct void_sink
 };
 
 
+// Compile-time passing policy: with DESCEND_PASS_SMALL_BY_VALUE defined, references to small trivially
+// copyable types (see small_by_value_t) are collapsed into values at stage boundaries. That lets the
+// compiler keep scalars in registers when not everything is inlined, but breaks identity of such elements:
+// stages and callables receive a copy, so the *_ref stages and returning std::cref(x) can't be used for them.
+#ifdef DESCEND_PASS_SMALL_BY_VALUE
+inline constexpr bool pass_small_by_value = true;
+#else
+inline constexpr bool pass_small_by_value = false;
+#endif
+
+template <class T>
+using stage_input_t = std::conditional_t<pass_small_by_value, small_by_value_t<T>, T>;
+
+// Parameter of stage_chain_component::process_incremental(): small trivially copyable values
+// are passed by value, everything else by reference
+template <class Input>
+using input_param_t = std::conditional_t<
+        !std::is_reference_v<Input> && is_small_trivially_copyable_v<Input>,
+        Input,
+        Input&&>;
+
+
 template <std::size_t I>
 struct index : std::integral_constant<std::size_t, I>{};
 
@@ -47,6 +70,7 @@ struct stage_chain_component
     using stage_type = typename StageImpl::stage_type;
     using input_type = typename StageImpl::input_type;
     using output_type = typename StageImpl::output_type;
+    using input_param_type = input_param_t<input_type>;
 
     constexpr decltype(auto) get(index<I>)
     { return *this; }
@@ -77,7 +101,11 @@ struct stage_chain_component
 
     constexpr bool done() const
     {
-        if constexpr (requires { m_stage_impl.done(); }) {
+        if constexpr (requires { m_stage_impl.done(next()); }) {
+            // stage combines its own state with next stages, e.g. deadline()
+            return m_stage_impl.done(next());
+        }
+        else if constexpr (requires { m_stage_impl.done(); }) {
             return m_stage_impl.done();
         }
         else {
@@ -89,8 +117,18 @@ struct stage_chain_component
         }
     }
 
+    // Expected number of elements to be passed to process_incremental(), sent before the processing
+    // when it is known (see has_known_size_v). It is only a hint: computation may stop earlier.
+    // Stages producing one output per input forward it to next stage, sinks may reserve memory.
+    constexpr void size_hint(const std::size_t n)
+    {
+        if constexpr (requires { m_stage_impl.size_hint(n, next()); }) {
+            m_stage_impl.size_hint(n, next());
+        }
+    }
+
     // incremental -> incremental
-    constexpr void process_incremental(input_type&& input)
+    constexpr void process_incremental(input_param_type input)
         requires (has_incremental_input<stage_type>())
     {
         m_stage_impl.process_incremental((input_type&&) input, next());
@@ -108,12 +146,21 @@ struct stage_chain_component
     constexpr decltype(auto) process_complete(Input&& input)
         requires (has_incremental_input<stage_type>())
     {
-        detail::iterate(
-                (Input&&) input,
-                [this] () { return done(); },
-                [this] (input_type&& elem) {
-                    m_stage_impl.process_incremental((input_type&&) elem, next());
-                });
+        if constexpr (has_known_size_v<Input&&>) {
+            size_hint(known_size(input));
+        }
+        if constexpr (requires { m_stage_impl.process_random_access(unwrap_input((Input&&) input), next()); }) {
+            // stage processes random access input at once, e.g. skipping some elements
+            m_stage_impl.process_random_access(unwrap_input((Input&&) input), next());
+        }
+        else {
+            detail::iterate(
+                    (Input&&) input,
+                    [this] () { return done(); },
+                    [this] (input_param_type elem) {
+                        m_stage_impl.process_incremental((input_type&&) elem, next());
+                    });
+        }
         return end();
     }
 
@@ -151,6 +198,9 @@ struct chain<std::index_sequence<Is...>, StageImpls...>
     constexpr bool done() const
     { return false; }
 
+    constexpr void size_hint(std::size_t)
+    { }
+
     template <class T = int>
     constexpr void end()
     {
@@ -187,7 +237,7 @@ struct stage_impl_helper
             return std::type_identity<iterate_output_with_unwrap_t<prev_output_type>>{};
         }
     }
-    using stage_input_type = typename decltype(stage_input_type_helper())::type;
+    using stage_input_type = stage_input_t<typename decltype(stage_input_type_helper())::type>;
 
     using stage_impl = decltype(std::declval<Stage>().template make_impl<stage_input_type>());
 };
@@ -0,0 +1,449 @@
+#pragma once
+
+#include "descend/chain.hpp"
+#include "descend/iterate.hpp"
+
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace descend {
+
+template <class T>
+class task;
+
+namespace detail {
+
+template <class T>
+struct task_promise_base
+{
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    struct final_awaiter
+    {
+        bool await_ready() const noexcept
+        { return false; }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+        {
+            const std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept
+        { }
+    };
+
+    std::suspend_always initial_suspend() const noexcept
+    { return {}; }
+
+    final_awaiter final_suspend() const noexcept
+    { return {}; }
+
+    void unhandled_exception() noexcept
+    { error = std::current_exception(); }
+
+    task<T> get_return_object() noexcept
+    { return task<T>{std::coroutine_handle<typename task<T>::promise_type>::from_promise(static_cast<typename task<T>::promise_type&>(*this))}; }
+};
+
+template <class T>
+struct task_promise : task_promise_base<T>
+{
+    std::optional<T> value;
+
+    template <class U = T>
+    void return_value(U&& result)
+    { value.emplace((U&&) result); }
+
+    T result()
+    {
+        if (this->error) {
+            std::rethrow_exception(this->error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct task_promise<void> : task_promise_base<void>
+{
+    void return_void() noexcept
+    { }
+
+    void result()
+    {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Coroutine started by event_loop::spawn(), destroys itself when it is finished
+struct detached_task
+{
+    struct promise_type
+    {
+        detached_task get_return_object() const noexcept
+        { return {}; }
+
+        std::suspend_never initial_suspend() const noexcept
+        { return {}; }
+
+        std::suspend_never final_suspend() const noexcept
+        { return {}; }
+
+        void return_void() const noexcept
+        { }
+
+        void unhandled_exception() const noexcept
+        { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+// Lazy coroutine returning T: starts when it is awaited (co_await, event_loop::spawn() or event_loop::run()),
+// the awaiting coroutine is resumed when it finishes. Exceptions are rethrown to the awaiting coroutine. Move-only.
+template <class T>
+class task
+{
+public:
+    using value_type = T;
+    using promise_type = detail::task_promise<T>;
+
+    task(task&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr))
+    {}
+
+    task& operator = (task&&) = delete;
+
+    ~task()
+    {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    auto operator co_await () && noexcept
+    {
+        struct awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept
+            { return false; }
+
+            std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) const noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() const
+            { return handle.promise().result(); }
+        };
+        return awaiter{m_handle};
+    }
+
+private:
+    friend struct detail::task_promise_base<T>;
+
+    explicit task(const std::coroutine_handle<promise_type> handle) noexcept
+        : m_handle(handle)
+    {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// Single-threaded epoll loop resuming coroutines which wait for file descriptors to become readable.
+// Tasks are started with spawn() and run while run() is running. Throws std::system_error on epoll errors.
+//
+//      dd::event_loop loop;
+//      for (const int fd : pipes) {
+//          loop.spawn(count_lines(loop, fd)); // a coroutine calling co_apply()
+//      }
+//      loop.run();
+class event_loop
+{
+public:
+    event_loop()
+        : m_epoll(::epoll_create1(EPOLL_CLOEXEC))
+    {
+        if (m_epoll < 0) {
+            throw std::system_error(errno, std::generic_category(), "event_loop: epoll_create1 failed");
+        }
+    }
+
+    event_loop(const event_loop&) = delete;
+    event_loop& operator = (const event_loop&) = delete;
+
+    ~event_loop()
+    {
+        ::close(m_epoll);
+    }
+
+    // Awaitable resuming the coroutine when 'fd' is readable, closed by the writer or has an error
+    auto readable(const int fd) noexcept
+    {
+        struct awaiter
+        {
+            event_loop& loop;
+            int fd;
+
+            bool await_ready() const noexcept
+            { return false; }
+
+            void await_suspend(const std::coroutine_handle<> handle) const
+            { loop.watch(fd, handle); }
+
+            void await_resume() const noexcept
+            { }
+        };
+        return awaiter{*this, fd};
+    }
+
+    // Starts the task, it runs until its first suspension and continues in run()
+    template <class T>
+    void spawn(task<T> t)
+    {
+        ++m_running;
+        run_detached(std::move(t));
+    }
+
+    // Runs until all spawned tasks are finished, then rethrows the first exception of them if any.
+    // Throws std::logic_error if tasks wait for something which is not a file descriptor of this loop
+    void run()
+    {
+        while (m_running != 0) {
+            if (m_waiting == 0) {
+                throw std::logic_error("event_loop: tasks are suspended, but don't wait for file descriptors");
+            }
+            poll();
+        }
+        if (m_error) {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+    }
+
+    // Spawns the task and runs until all tasks are finished, returns the result of the task
+    template <class T>
+    T run(task<T> t)
+    {
+        if constexpr (std::is_void_v<T>) {
+            spawn(std::move(t));
+            run();
+        }
+        else {
+            std::optional<T> result;
+            spawn(store_result(std::move(t), result));
+            run();
+            return std::move(*result);
+        }
+    }
+
+private:
+    template <class T>
+    detail::detached_task run_detached(task<T> t)
+    {
+        try {
+            co_await std::move(t);
+        }
+        catch (...) {
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+        }
+        --m_running;
+    }
+
+    template <class T>
+    static task<void> store_result(task<T> t, std::optional<T>& result)
+    {
+        result.emplace(co_await std::move(t));
+    }
+
+    void watch(const int fd, const std::coroutine_handle<> handle)
+    {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = handle.address();
+        if (::epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event) != 0
+            && (errno != ENOENT || ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0))
+        {
+            throw std::system_error(errno, std::generic_category(), "event_loop: epoll_ctl failed");
+        }
+        ++m_waiting;
+    }
+
+    void poll()
+    {
+        epoll_event events[64];
+        const int count = ::epoll_wait(m_epoll, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                return;
+            }
+            throw std::system_error(errno, std::generic_category(), "event_loop: epoll_wait failed");
+        }
+        for (int i = 0; i < count; ++i) {
+            --m_waiting;
+            std::coroutine_handle<>::from_address(events[i].data.ptr).resume();
+        }
+    }
+
+    int m_epoll;
+    std::size_t m_running = 0;
+    std::size_t m_waiting = 0;
+    std::exception_ptr m_error;
+};
+
+// Asynchronous source of lines ('\n' is not included) read from a non-blocking file descriptor (pipe, socket),
+// suspending in the event loop when no data is available. Every batch is a span of lines valid until the next batch.
+// The last line without '\n' is passed at the end of input. The descriptor is switched to non-blocking mode
+// and is not closed. Throws std::system_error on read errors.
+class async_lines_source
+{
+public:
+    async_lines_source(event_loop& loop, const int fd, const std::size_t read_size)
+        : m_loop(&loop)
+        , m_fd(fd)
+        , m_read_size(read_size)
+    {
+        if (read_size == 0) {
+            throw std::invalid_argument("async_lines: read_size should be positive");
+        }
+        const int flags = ::fcntl(fd, F_GETFL);
+        if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+            throw std::system_error(errno, std::generic_category(), "async_lines: can't make descriptor non-blocking");
+        }
+    }
+
+    // Next lines, std::nullopt at the end of input
+    task<std::optional<std::span<const std::string_view>>> next_batch()
+    {
+        m_buffer.erase(0, m_consumed);
+        m_consumed = 0;
+        m_lines.clear();
+        while (!m_eof) {
+            const std::size_t old_size = m_buffer.size();
+            m_buffer.resize(old_size + m_read_size);
+            const ssize_t n = ::read(m_fd, m_buffer.data() + old_size, m_read_size);
+            m_buffer.resize(old_size + static_cast<std::size_t>(n > 0 ? n : 0));
+            if (n > 0) {
+                // the data before old_size is a part of the line without '\n'
+                split_lines(old_size);
+                if (!m_lines.empty()) {
+                    co_return std::span<const std::string_view>(m_lines);
+                }
+            }
+            else if (n == 0) {
+                m_eof = true;
+                if (!m_buffer.empty()) {
+                    m_lines.emplace_back(m_buffer);
+                    m_consumed = m_buffer.size();
+                    co_return std::span<const std::string_view>(m_lines);
+                }
+            }
+            else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                co_await m_loop->readable(m_fd);
+            }
+            else if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "async_lines: read failed");
+            }
+        }
+        co_return std::nullopt;
+    }
+
+private:
+    void split_lines(const std::size_t from)
+    {
+        std::size_t start = 0;
+        const char* data = m_buffer.data();
+        for (const char* p = data + from; (p = static_cast<const char*>(std::memchr(p, '\n', m_buffer.size() - static_cast<std::size_t>(p - data)))) != nullptr; ++p) {
+            const auto end = static_cast<std::size_t>(p - data);
+            m_lines.emplace_back(data + start, end - start);
+            start = end + 1;
+        }
+        m_consumed = start;
+    }
+
+    event_loop* m_loop;
+    int m_fd;
+    std::size_t m_read_size;
+    std::string m_buffer;
+    std::size_t m_consumed = 0;
+    std::vector<std::string_view> m_lines;
+    bool m_eof = false;
+};
+
+// Lines of a pipe or socket 'fd' for co_apply(), see async_lines_source
+inline async_lines_source async_lines(event_loop& loop, const int fd, const std::size_t read_size = std::size_t{1} << 16)
+{
+    return async_lines_source{loop, fd, read_size};
+}
+
+namespace detail {
+
+// Async sources have next_batch() returning task<std::optional<Batch>>, where Batch is iterable
+// (a range, a span into the source or a generator), std::nullopt means the end of input
+template <class Source>
+using async_batch_t = typename decltype(std::declval<Source&>().next_batch())::value_type::value_type;
+
+template <class Source>
+using async_element_t = iterate_output_with_unwrap_t<async_batch_t<Source>&&>;
+
+template <class Source, class... Stages>
+using co_apply_chain_t = decltype(make_subchain_for_input<async_element_t<Source>>(std::declval<Stages>()...));
+
+} // namespace detail
+
+// apply() for asynchronous sources: a coroutine which feeds batches of the source into the chain of stages,
+// suspending while the source waits for more data, and returns the result of the chain.
+// The source and the stages are moved into the coroutine. Stops reading when the chain is done (e.g. take_n()).
+// Runs in event_loop, many pipelines can run concurrently in one thread:
+//
+//      dd::task<std::size_t> count_errors(dd::event_loop& loop, int fd)
+//      {
+//          co_return co_await dd::co_apply(dd::async_lines(loop, fd),
+//                  dd::filter([] (std::string_view line) { return line.starts_with("ERROR"); }),
+//                  dd::count());
+//      }
+//
+// Include descend/co_apply.hpp separately (Linux only, epoll).
+template <class Source, class... Stages>
+task<std::remove_cvref_t<detail::subchain_end_t<detail::co_apply_chain_t<Source, Stages...>>>>
+co_apply(Source source, Stages... stages)
+{
+    auto chain = detail::make_subchain_for_input<detail::async_element_t<Source>>(std::move(stages)...);
+    auto& head = chain.get(detail::index<0>{});
+    while (!head.done()) {
+        auto batch = co_await source.next_batch();
+        if (!batch) {
+            break;
+        }
+        detail::iterate(std::move(*batch), [&head] { return head.done(); }, [&head] <class T> (T&& element) {
+            head.process_incremental((T&&) element);
+        });
+    }
+    co_return head.end();
+}
+
+} // namespace descend
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/helpers.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+namespace detail {
+
+/*
+Struct-of-arrays source: iterates several columns in lockstep, yielding args<> with one element of every column.
+Each column follows the same rules as unwrap_input() does for the whole input:
+    x            -> column elements are const X::value_type&
+    std::ref(x)  -> column elements are X::value_type&
+    std::move(x) -> column is moved into the source, elements are X::value_type&& when the source
+                    itself is iterated as rvalue, const& otherwise
+*/
+template <class Column>
+struct column_storage
+{
+    // lvalue: keep const reference
+    using type = const std::remove_reference_t<Column>&;
+};
+template <class Column>
+    requires (   !std::is_lvalue_reference_v<Column>
+              && !is_specialization_of_v<std::reference_wrapper, std::remove_cvref_t<Column>>)
+struct column_storage<Column>
+{
+    // rvalue: own the column
+    using type = std::remove_cvref_t<Column>;
+};
+template <class Column>
+    requires is_specialization_of_v<std::reference_wrapper, std::remove_cvref_t<Column>>
+struct column_storage<Column>
+{
+    // std::ref: keep reference
+    using type = typename std::remove_cvref_t<Column>::type&;
+};
+template <class Column>
+using column_storage_t = typename column_storage<Column>::type;
+
+template <class Stored>
+constexpr decltype(auto) unwrap_column(Stored&& column) noexcept
+{
+    if constexpr (is_specialization_of_v<std::reference_wrapper, std::remove_cvref_t<Stored>>) {
+        return column.get();
+    }
+    else {
+        return (Stored&&) column;
+    }
+}
+
+// Element of column Stored (see column_storage) when the source is iterated as Self
+template <class Stored, class Self>
+using column_element_t = std::conditional_t<
+        std::is_reference_v<Stored>,
+        std::ranges::range_reference_t<Stored>,
+        decltype(forward_like<Self>(*std::ranges::begin(std::declval<Stored&>())))>;
+
+template <class... Columns>
+struct columns_source
+{
+    static_assert(sizeof...(Columns) != 0, "columns() requires at least one column");
+    static_assert((std::ranges::sized_range<Columns> && ...),
+            "columns() requires sized ranges");
+
+    using custom_source_tag = void;
+
+    template <class Self>
+    using output_type = args<column_element_t<Columns, Self>...>;
+
+    // true if every column is contiguous, then column<I>() can be used as std::span
+    static constexpr bool is_contiguous = (std::ranges::contiguous_range<Columns> && ...);
+
+    std::tuple<Columns...> columns;
+
+    template <class... Args>
+    constexpr explicit columns_source(std::in_place_t, Args&&... args)
+        : columns(unwrap_column((Args&&) args)...)
+    {
+        const auto sizes_are_equal = std::apply([this] (const auto&... cols) {
+            return ((std::ranges::size(cols) == size()) && ...);
+        }, columns);
+        if (!sizes_are_equal) {
+            throw std::length_error("columns() requires all columns to have the same size");
+        }
+    }
+
+    constexpr std::size_t size() const
+    {
+        return static_cast<std::size_t>(std::ranges::size(std::get<0>(columns)));
+    }
+
+    // Access to the column, as std::span if it is contiguous
+    template <std::size_t I>
+    constexpr auto column() const
+    {
+        using column_type = std::tuple_element_t<I, std::tuple<Columns...>>;
+        if constexpr (std::ranges::contiguous_range<column_type>) {
+            return std::span{std::ranges::data(std::get<I>(columns)), size()};
+        }
+        else {
+            return std::cref(std::get<I>(columns));
+        }
+    }
+
+    template <class Self, class Done, class Callback>
+    static constexpr void iterate(Self&& self, Done&& done, Callback&& callback)
+    {
+        using output = output_type<Self&&>;
+
+        std::apply([&] <class... Cols> (Cols&... cols) {
+            auto iterators = std::tuple{std::ranges::begin(cols)...};
+            const std::size_t rows = self.size();
+
+            for (std::size_t i = 0; i < rows && !done(); ++i) {
+                std::apply([&callback] (auto&... its) {
+                    callback(output{static_cast<column_element_t<Columns, Self&&>>(*its)...});
+                    (++its, ...);
+                }, iterators);
+            }
+        }, self.columns);
+    }
+};
+
+} // namespace detail
+
+// Iterates columns in lockstep, yielding args<> with an element of every column:
+//
+//      std::vector<std::int64_t> ts = ...;
+//      std::vector<double> price = ...;
+//      dd::apply(dd::columns(ts, price), dd::for_each([] (const std::int64_t& ts, const double& price) { ... }));
+//
+// Use std::ref(column) for non-const access and std::move(column) to pass ownership to the source.
+// All columns should have the same size, std::length_error is thrown otherwise.
+template <class... Columns>
+constexpr auto columns(Columns&&... cols)
+{
+    return detail::columns_source<detail::column_storage_t<Columns&&>...>{std::in_place, (Columns&&) cols...};
+}
+
+} // namespace descend
@@ -20,8 +20,8 @@ struct composition : std::tuple<Ts...>
 
     template <class Tuple>
         requires std::is_constructible_v<tuple_type, Tuple>
-    constexpr composition(Tuple&& tuple) noexcept(std::is_nothrow_constructible_v<tuple_type, Tuple>)
-        : tuple_type((Tuple&&) tuple)
+    constexpr composition(Tuple&& t) noexcept(std::is_nothrow_constructible_v<tuple_type, Tuple>)
+        : tuple_type((Tuple&&) t)
     { }
 
     constexpr decltype(auto) as_tuple() & noexcept
@@ -107,6 +107,18 @@ constexpr decltype(auto) apply_to_decomposed(Func&& func, Parts&&... parts)
         return std::invoke((Func&&) func, (Args&&) args...);
     }, detail::forward_compose((Parts&&) parts...).as_tuple());
 }
+
+// Stages writing into caller-owned state (like into(std::ref(container))) declare
+// 'static constexpr bool shares_caller_state = true': all chains created from such stage use the same state.
+// Higher order stages propagate it from their subchains, map_group_by rejects it,
+// since its groups would overwrite each other.
+template <class Part>
+struct shares_caller_state : std::bool_constant<requires { requires std::remove_cvref_t<Part>::shares_caller_state; }>{};
+template <class... Ts>
+struct shares_caller_state<composition<Ts...>> : std::bool_constant<(shares_caller_state<Ts>::value || ...)>{};
+
+template <class Part>
+inline constexpr bool shares_caller_state_v = shares_caller_state<std::remove_cvref_t<Part>>::value;
 } // namespace detail
 
 } // namespace descend
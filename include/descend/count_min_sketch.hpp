@@ -0,0 +1,113 @@
+#pragma once
+
+#include "descend/helpers.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace descend {
+
+// Count-Min sketch (Cormode, Muthukrishnan, 2005) over 64-bit hashes: 'depth' rows of 'width' counters,
+// frequency estimate is the minimum of the counters of the hash in every row. It never underestimates,
+// overestimate is at most 2 * total / width with probability 1 - 2^-depth.
+//
+// Counters are stored row after row in one array. Counter index in row i is the low bits of the hash
+// remixed with row number, so rows are independent (double hashing h1 + i * h2 would make indices
+// of all rows depend on only 2 * log2(width) bits of the hash). Indices of all rows are computed
+// in one loop without dependencies, and update/estimate are plain loops over them, which compilers vectorize.
+//
+// Sketches with the same dimensions can be merged.
+class count_min_sketch
+{
+public:
+    static constexpr std::size_t max_depth = 16;
+
+    // Width is rounded up to a power of two. Throws std::invalid_argument if width is 0 or depth is not in [1, 16]
+    explicit count_min_sketch(const std::size_t width = 2048, const std::size_t depth = 4)
+    {
+        validate(width, depth);
+        m_width = std::bit_ceil(width);
+        m_depth = depth;
+        m_counters.assign(m_width * m_depth, 0);
+    }
+
+    // Throws std::invalid_argument if width is 0 or depth is not in [1, 16]
+    static void validate(const std::size_t width, const std::size_t depth)
+    {
+        if (width == 0 || depth == 0 || depth > max_depth) {
+            throw std::invalid_argument("count_min_sketch: width should be positive and depth should be in [1, 16]");
+        }
+    }
+
+    std::size_t width() const noexcept
+    { return m_width; }
+
+    std::size_t depth() const noexcept
+    { return m_depth; }
+
+    // Sum of all added counts
+    std::uint64_t total() const noexcept
+    { return m_total; }
+
+    // Adds 'count' occurrences of the hash, returns the new estimate for it
+    std::uint64_t add_hash(const std::uint64_t hash, const std::uint64_t count = 1) noexcept
+    {
+        std::size_t indices[max_depth];
+        compute_indices(hash, indices);
+
+        std::uint64_t estimate = std::numeric_limits<std::uint64_t>::max();
+        for (std::size_t i = 0; i < m_depth; ++i) {
+            auto& counter = m_counters[indices[i]];
+            counter += count;
+            estimate = std::min(estimate, counter);
+        }
+        m_total += count;
+        return estimate;
+    }
+
+    std::uint64_t estimate_hash(const std::uint64_t hash) const noexcept
+    {
+        std::size_t indices[max_depth];
+        compute_indices(hash, indices);
+
+        std::uint64_t estimate = std::numeric_limits<std::uint64_t>::max();
+        for (std::size_t i = 0; i < m_depth; ++i) {
+            estimate = std::min(estimate, m_counters[indices[i]]);
+        }
+        return estimate;
+    }
+
+    // Throws std::invalid_argument if dimensions differ
+    void merge(const count_min_sketch& other)
+    {
+        if (other.m_width != m_width || other.m_depth != m_depth) {
+            throw std::invalid_argument("count_min_sketch: can't merge sketches with different dimensions");
+        }
+        for (std::size_t i = 0; i < m_counters.size(); ++i) {
+            m_counters[i] += other.m_counters[i];
+        }
+        m_total += other.m_total;
+    }
+
+private:
+    void compute_indices(const std::uint64_t hash, std::size_t* indices) const noexcept
+    {
+        const std::uint64_t mask = m_width - 1;
+        for (std::size_t i = 0; i < m_depth; ++i) {
+            const std::uint64_t row_hash = detail::splitmix64::mix(hash + i * 0x9e3779b97f4a7c15ULL);
+            indices[i] = i * m_width + static_cast<std::size_t>(row_hash & mask);
+        }
+    }
+
+    std::size_t m_width;
+    std::size_t m_depth;
+    std::uint64_t m_total = 0;
+    std::vector<std::uint64_t> m_counters;
+};
+
+} // namespace descend
@@ -9,6 +9,7 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 
 namespace descend::detail {
 
@@ -125,12 +126,12 @@ struct stages_printer<std::tuple<StageImpls...>>
 {
     static void print(std::ostream& strm, const std::size_t depth = 0)
     {
-        const auto print_stage = [&] <class StageImpl> (std::ostream& strm, const std::size_t index) {
+        const auto print_stage = [&] <class StageImpl> (std::ostream& out, const std::size_t index) {
             // Generic debug info
-            debug_print_stage_default<StageImpl>(strm, depth, index);
+            debug_print_stage_default<StageImpl>(out, depth, index);
 
             // Custom stage-specific debug info
-            debug_print_stage_custom<StageImpl>(strm, depth);
+            debug_print_stage_custom<StageImpl>(out, depth);
         };
 
         std::size_t index = 0;
@@ -184,8 +185,12 @@ struct custom_debug_printer<stages::map_group_by_stage<Map, KeyGetter, ComposedC
     {
         using chain_type = typename StageImpl::chain_type;
         using key_type = typename StageImpl::key_type;
+        using owning_key_type = typename StageImpl::owning_key_type;
 
         strm << indent(depth) << "  Key type: " << std::quoted(type_name<key_type>()) << '\n';
+        if constexpr (!std::is_same_v<key_type, owning_key_type>) {
+            strm << indent(depth) << "  Owning key type: " << std::quoted(type_name<owning_key_type>()) << '\n';
+        }
         strm << indent(depth) << "  Per-group chain:\n";
         debug_print_chain<chain_type>(strm, depth + 2);
     }
@@ -1,5 +1,17 @@
 #pragma once
 
 #include "descend/stages.hpp"       // IWYU pragma: export
+#include "descend/columns.hpp"      // IWYU pragma: export
 #include "descend/apply.hpp"        // IWYU pragma: export
 #include "descend/higher_order.hpp" // IWYU pragma: export
+#include "descend/packed_key.hpp"   // IWYU pragma: export
+#include "descend/stages/count_distinct.hpp" // IWYU pragma: export
+#include "descend/stages/sample.hpp" // IWYU pragma: export
+#include "descend/stages/quantiles.hpp" // IWYU pragma: export
+#include "descend/stages/top_frequent.hpp" // IWYU pragma: export
+#include "descend/stages/histogram.hpp" // IWYU pragma: export
+#include "descend/stages/stats.hpp" // IWYU pragma: export
+#include "descend/stages/parse.hpp" // IWYU pragma: export
+#include "descend/stages/memoize.hpp" // IWYU pragma: export
+#include "descend/stages/transform_batch.hpp" // IWYU pragma: export
+#include "descend/stages/deadline.hpp" // IWYU pragma: export
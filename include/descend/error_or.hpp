@@ -4,6 +4,7 @@
 #include "descend/iterate.hpp"
 #include "descend/stage_styles.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <system_error>
 #include <type_traits>
@@ -121,6 +122,12 @@ struct unwrap_error_or_stage
             }
         }
 
+        template <class Next>
+        void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
+
         bool done() const
         {
             return carrier.has_error();
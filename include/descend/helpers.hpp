@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -33,6 +35,36 @@ constexpr auto&& forward_like(U&& x) noexcept
 template <class T>
 inline constexpr bool always_false_v = false;
 
+// Small and fast PRNG with 8 bytes of state, used by randomized stages (sampling, sketches)
+struct splitmix64
+{
+    std::uint64_t state;
+
+    // splitmix64 finalizer, also good as a hash mixer
+    static constexpr std::uint64_t mix(std::uint64_t z) noexcept
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    constexpr std::uint64_t operator () () noexcept
+    {
+        return mix(state += 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+// Default hash for sketches: std::hash<T> with splitmix64 finalizer on top,
+// since std::hash for integers is usually identity
+struct mixed_std_hash
+{
+    template <class T>
+    std::uint64_t operator () (const T& value) const noexcept(noexcept(std::hash<T>{}(value)))
+    {
+        return splitmix64::mix(static_cast<std::uint64_t>(std::hash<T>{}(value)));
+    }
+};
+
 template <template <class...> class Template, class T>
 struct is_specialization_of : std::false_type{};
 
@@ -4,7 +4,10 @@
 #include "descend/chain.hpp"
 #include "descend/iterate.hpp"
 
+#include <cstddef>
+#include <functional>
 #include <optional>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -15,6 +18,7 @@ template <class... Subchains>
 struct tee_stage
 {
     static constexpr auto style = stage_styles::incremental_to_complete;
+    static constexpr bool shares_caller_state = (shares_caller_state_v<Subchains> || ...);
 
     std::tuple<Subchains...> subchains;
 
@@ -37,8 +41,10 @@ struct tee_stage
 
         static constexpr auto make_result_tuple(chains_tuple& chains)
         {
+            // not std::make_tuple(): it would unwrap std::reference_wrapper results (e.g. from into())
+            // to references, and finalize() would make copies of them
             return std::apply([] (auto&&... chain) {
-                return std::make_tuple(chain.get(detail::index<0>{}).end()...);
+                return std::tuple<decltype(chain.get(detail::index<0>{}).end())...>{chain.get(detail::index<0>{}).end()...};
             }, chains);
         }
 
@@ -56,6 +62,14 @@ struct tee_stage
             }, chains);
         }
 
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&&)
+        {
+            std::apply([n] (auto&&... chain) {
+                (chain.get(detail::index<0>{}).size_hint(n), ...);
+            }, chains);
+        }
+
         template <class Next>
         constexpr auto end(Next&& next)
         {
@@ -83,25 +97,126 @@ struct tee_stage
 // corresponding to it's key
 //
 // after all elements processed passes key + chain.end() to the next element in the whole computation
-template <class Key, class ChainResult>
-struct prepend_key_to_args
+template <class KeysTuple, class ChainResult>
+struct prepend_keys_to_args;
+template <class... Keys, class ChainResult>
+struct prepend_keys_to_args<std::tuple<Keys...>, ChainResult>
 {
     static_assert(!is_specialization_of_v<args, std::remove_cvref_t<ChainResult>>);
-    using type = args<Key, ChainResult &&>;
+    using type = args<Keys..., ChainResult &&>;
 };
-template <class Key, class... Args>
-struct prepend_key_to_args<Key, args<Args...>>
+template <class... Keys, class... Args>
+struct prepend_keys_to_args<std::tuple<Keys...>, args<Args...>>
 {
-    using type = args<Key, Args...>;
+    using type = args<Keys..., Args...>;
 };
+template <class KeysTuple, class ChainResult>
+using prepend_keys_to_args_t = typename prepend_keys_to_args<KeysTuple, ChainResult>::type;
+
 template <class Key, class ChainResult>
-using prepend_key_to_args_t = typename prepend_key_to_args<Key, ChainResult>::type;
+using prepend_key_to_args_t = prepend_keys_to_args_t<std::tuple<Key>, ChainResult>;
+
+// Key getter may provide static unpack_key(const Key&) returning std::tuple of key parts (see packed_key()),
+// then these parts are passed further instead of the key itself
+template <class KeyGetter, class Key>
+inline constexpr bool has_unpack_key_v = requires (const Key& key) {
+    std::remove_cvref_t<KeyGetter>::unpack_key(key);
+};
+
+// Key getter wrapper for map_group_by which splits the key into lookup and owning parts.
+// KeyGetter returns a cheap lookup key (e.g. std::string_view into the record),
+// map stores Owning (e.g. std::string) which is constructed only when a new group is inserted.
+template <class Owning, class KeyGetter>
+struct owning_key_getter
+{
+    using owning_key_type = Owning;
+
+    [[no_unique_address]]
+    KeyGetter key_getter;
+
+    template <class Input>
+    constexpr decltype(auto) operator () (Input&& input)
+    {
+        return std::invoke(key_getter, (Input&&) input);
+    }
+    template <class Input>
+    constexpr decltype(auto) operator () (Input&& input) const
+    {
+        return std::invoke(key_getter, (Input&&) input);
+    }
+};
+
+template <class KeyGetter, class LookupKey>
+struct owning_key_type_helper
+{
+    using type = LookupKey;
+};
+template <class KeyGetter, class LookupKey>
+    requires requires { typename std::remove_cvref_t<KeyGetter>::owning_key_type; }
+struct owning_key_type_helper<KeyGetter, LookupKey>
+{
+    using type = typename std::remove_cvref_t<KeyGetter>::owning_key_type;
+};
+
+// Hashes owning and lookup keys the same way by converting both to Lookup.
+// Requires std::hash<Lookup> to be consistent for both, as it is for std::string and std::string_view
+template <class Lookup>
+struct transparent_key_hash
+{
+    using is_transparent = void;
+
+    template <class Key>
+    constexpr std::size_t operator () (const Key& key) const
+    {
+        return std::hash<Lookup>{}(Lookup(key));
+    }
+};
+
+// Selects Map type for map_group_by.
+// When owning and lookup keys differ, ordered maps get std::less<> and unordered maps get
+// transparent hash and std::equal_to<>, so the lookup key can be used for find() without conversion.
+// Other maps are instantiated as is, then every lookup constructs the owning key.
+template <template <class...> class Map, class Owning, class Lookup, class Value>
+consteval auto map_for_keys_helper() noexcept
+{
+    using default_map = Map<Owning, Value>;
+    if constexpr (std::is_same_v<Owning, Lookup>) {
+        return std::type_identity<default_map>{};
+    }
+    else if constexpr (requires { typename default_map::hasher; }) {
+        return std::type_identity<Map<Owning, Value, transparent_key_hash<Lookup>, std::equal_to<>>>{};
+    }
+    else if constexpr (requires { typename default_map::key_compare; }) {
+        return std::type_identity<Map<Owning, Value, std::less<>>>{};
+    }
+    else {
+        return std::type_identity<default_map>{};
+    }
+}
+template <template <class...> class Map, class Owning, class Lookup, class Value>
+using map_for_keys_t = typename decltype(map_for_keys_helper<Map, Owning, Lookup, Value>())::type;
+
+template <class KeyGetter, class Key, class KeyRef>
+struct key_args_tuple_helper
+{
+    using type = std::tuple<KeyRef>;
+};
+template <class KeyGetter, class Key, class KeyRef>
+    requires has_unpack_key_v<KeyGetter, Key>
+struct key_args_tuple_helper<KeyGetter, Key, KeyRef>
+{
+    using type = decltype(std::remove_cvref_t<KeyGetter>::unpack_key(std::declval<const Key&>()));
+};
 
 template <template <class...> class Map, class KeyGetter, class ComposedChain>
 struct map_group_by_stage
 {
     static constexpr auto style = stage_styles::incremental_to_incremental;
 
+    static_assert(!shares_caller_state_v<ComposedChain>,
+            "map_group_by keeps chains of all groups alive at once, stages writing into caller-owned state "
+            "(e.g. into(std::ref(container))) can't be used inside it");
+
     [[no_unique_address]]
     KeyGetter key_getter;
     [[no_unique_address]]
@@ -123,24 +238,30 @@ struct map_group_by_stage
         // aggregation key: result of invoking KeyGetter with const Input&
         using key_type = std::remove_cvref_t<std::invoke_result_t<KeyGetter&, const std::remove_cvref_t<Input>&>>;
 
+        // key stored in the map, differs from key_type only for owning_key()
+        using owning_key_type = typename owning_key_type_helper<KeyGetter, key_type>::type;
+
         // result of calling chain.end()
         using chain_result_type = std::remove_cvref_t<subchain_end_t<chain_type>>;
 
         // key to chain map
-        using map_type = Map<key_type, chain_type>;
+        using map_type = map_for_keys_t<Map, owning_key_type, key_type, chain_type>;
 
         // we need to understand whether the key be non-const when we iterate through moved map_type
         using iterate_output_type = iterate_output_t<map_type &&>;
         // in order to provide right args<> as output
         using key_ref_type = typename std::remove_reference_t<iterate_output_type>::first_type &&;
 
+        // tuple of types to pass as key arguments to the next stage
+        using key_args_tuple = typename key_args_tuple_helper<KeyGetter, owning_key_type, key_ref_type>::type;
+
         using input_type = Input;
-        using output_type = prepend_key_to_args_t<key_ref_type, chain_result_type>;
+        using output_type = prepend_keys_to_args_t<key_args_tuple, chain_result_type>;
         using stage_type = map_group_by_stage;
         using display_stage_type = struct map_group_by_stage_; // display name would be just 'map_group_by_stage_'
                                                                // instead of 'map_group_by_stage<lots of other types...>'
 
-        Map<key_type, chain_type> chains = {};
+        map_type chains = {};
 
         struct chain_maker
         {
@@ -156,8 +277,22 @@ struct map_group_by_stage
         {
             auto&& key = std::invoke(key_getter, std::as_const(input));
 
-            auto [it, _] = chains.try_emplace(std::forward<decltype(key)>(key), chain_maker{composed_chain});
-            it->second.get(detail::index<0>{}).process_incremental((Input&&) input);
+            if constexpr (std::is_same_v<owning_key_type, key_type>) {
+                auto [it, _] = chains.try_emplace(std::forward<decltype(key)>(key), chain_maker{composed_chain});
+                it->second.get(detail::index<0>{}).process_incremental((Input&&) input);
+            }
+            else if constexpr (requires { chains.find(std::as_const(key)); }) {
+                // heterogeneous lookup first, owning key is constructed only for a new group
+                auto it = chains.find(std::as_const(key));
+                if (it == chains.end()) {
+                    it = chains.try_emplace(owning_key_type(std::forward<decltype(key)>(key)), chain_maker{composed_chain}).first;
+                }
+                it->second.get(detail::index<0>{}).process_incremental((Input&&) input);
+            }
+            else {
+                auto [it, _] = chains.try_emplace(owning_key_type(std::forward<decltype(key)>(key)), chain_maker{composed_chain});
+                it->second.get(detail::index<0>{}).process_incremental((Input&&) input);
+            }
         }
 
         template <class Next>
@@ -169,8 +304,16 @@ struct map_group_by_stage
                 std::apply([&next] <class Key, class Chain> (Key&& key, Chain&& chain) {
                     // chain.end() can be args<>, we would like to separate it as well
                     args_invoke([&] <class... Args> (Args&&... args) {
-                        // pass key and args to next as args<Key&&, Args&&...>
-                        next.process_incremental({(Key&&) key, (Args&&) args...});
+                        if constexpr (has_unpack_key_v<KeyGetter, owning_key_type>) {
+                            // pass unpacked key parts and args to next as args<KeyParts..., Args&&...>
+                            std::apply([&] <class... KeyParts> (KeyParts&&... key_parts) {
+                                next.process_incremental({(KeyParts&&) key_parts..., (Args&&) args...});
+                            }, std::remove_cvref_t<KeyGetter>::unpack_key(std::as_const(key)));
+                        }
+                        else {
+                            // pass key and args to next as args<Key&&, Args&&...>
+                            next.process_incremental({(Key&&) key, (Args&&) args...});
+                        }
                     }, chain.get(detail::index<0>{}).end());
                 }, (Elem&&) elem);
             };
@@ -211,6 +354,7 @@ template <class KeyGetter, class ComposedChain>
 struct group_by_stage
 {
     static constexpr auto style = stage_styles::incremental_to_incremental;
+    static constexpr bool shares_caller_state = shares_caller_state_v<ComposedChain>;
 
     [[no_unique_address]]
     KeyGetter key_getter;
@@ -319,6 +463,18 @@ constexpr auto map_group_by(KeyGetter&& key_getter, Stages&&... stages)
         (KeyGetter&&) key_getter, std::move(composed_chain) };
 }
 
+// Wraps key getter for map_group_by: the map stores Owning keys, while lookup is done
+// with whatever key getter returns (e.g. Owning = std::string for std::string_view keys).
+//
+//      dd::map_group_by<std::unordered_map>(
+//              dd::owning_key<std::string>([] (const Record& r) { return std::string_view{r.name}; }),
+//              dd::count())
+template <class Owning, class KeyGetter>
+constexpr auto owning_key(KeyGetter&& key_getter)
+{
+    return detail::stages::owning_key_getter<Owning, std::remove_cvref_t<KeyGetter>>{(KeyGetter&&) key_getter};
+}
+
 template <class KeyGetter, class... Stages>
 constexpr auto group_by(KeyGetter&& key_getter, Stages&&... stages)
 {
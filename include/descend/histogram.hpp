@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace descend {
+
+// Histogram with explicit bin edges e0 < e1 < ... < en: bin i counts values in [e(i), e(i+1)),
+// values below e0 (and NaN) are counted as underflow, values not below en as overflow.
+// Bin is found with branchless binary search over the edges.
+// Histograms with the same edges can be merged.
+class fixed_bin_histogram
+{
+public:
+    // Throws std::invalid_argument if there are less than 2 edges or they are not strictly increasing
+    explicit fixed_bin_histogram(std::vector<double> edges)
+        : m_edges(std::move(edges))
+    {
+        if (m_edges.size() < 2) {
+            throw std::invalid_argument("histogram: at least 2 edges are required");
+        }
+        for (std::size_t i = 0; i + 1 < m_edges.size(); ++i) {
+            if (!(m_edges[i] < m_edges[i + 1])) {
+                throw std::invalid_argument("histogram: edges should be strictly increasing");
+            }
+        }
+        m_counts.assign(m_edges.size() + 1, 0);
+    }
+
+    const std::vector<double>& edges() const noexcept
+    { return m_edges; }
+
+    std::size_t bins() const noexcept
+    { return m_edges.size() - 1; }
+
+    // Count of values in [edges()[i], edges()[i + 1])
+    std::uint64_t count(const std::size_t i) const noexcept
+    { return m_counts[i + 1]; }
+
+    std::uint64_t underflow() const noexcept
+    { return m_counts.front(); }
+
+    std::uint64_t overflow() const noexcept
+    { return m_counts.back(); }
+
+    // Number of added values, including underflow and overflow
+    std::uint64_t total() const noexcept
+    {
+        std::uint64_t sum = 0;
+        for (const std::uint64_t c : m_counts) {
+            sum += c;
+        }
+        return sum;
+    }
+
+    void add(const double value, const std::uint64_t count = 1) noexcept
+    { m_counts[slot(value)] += count; }
+
+    // Searches of consecutive values are independent and already overlap in the CPU,
+    // computing indices separately (see log_linear_histogram::add_batch) doesn't pay off here
+    void add_batch(const std::span<const double> values) noexcept
+    {
+        for (const double value : values) {
+            add(value);
+        }
+    }
+
+    // Throws std::invalid_argument if edges differ
+    void merge(const fixed_bin_histogram& other)
+    {
+        if (other.m_edges != m_edges) {
+            throw std::invalid_argument("histogram: can't merge histograms with different edges");
+        }
+        for (std::size_t i = 0; i < m_counts.size(); ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+    }
+
+    // Number of edges not greater than value: 0 is underflow, edges().size() is overflow
+    std::size_t slot(const double value) const noexcept
+    {
+        const double* base = m_edges.data();
+        std::size_t len = m_edges.size();
+        while (len > 1) {
+            const std::size_t half = len / 2;
+            base = base[half] <= value ? base + half : base;
+            len -= half;
+        }
+        return static_cast<std::size_t>(base - m_edges.data()) + (*base <= value ? 1 : 0);
+    }
+
+private:
+    std::vector<double> m_edges;
+    std::vector<std::uint64_t> m_counts; // underflow, bins..., overflow
+};
+
+// Log-linear histogram in the style of HdrHistogram for non-negative values (latencies, sizes) up to 'max':
+// every power of two range is split into linear sub-bins, so a value is counted in a bin whose width
+// is at most 10^-precision of the value, with 'precision' significant decimal digits in [1, 5].
+// Unit of the histogram is 2^floor(log2(min)), 'min' is the lowest discernible value:
+// values below 10^precision units are counted with the unit resolution.
+// Negative values (and NaN) are counted as underflow, values above 'max' as overflow.
+// Bin index is computed from the bit width of the value without branches.
+// Histograms with the same parameters can be merged.
+class log_linear_histogram
+{
+public:
+    // Throws std::invalid_argument if min < 1, max < 2 * min or precision is not in [1, 5]
+    log_linear_histogram(const double min, const double max, const unsigned precision)
+        : m_min(min), m_max(max), m_precision(precision)
+    {
+        if (!(min >= 1.0) || !(max >= 2.0 * min) || !(max < 0x1.0p63) || precision < 1 || precision > 5) {
+            throw std::invalid_argument("log_histogram: should be 1 <= min, 2 * min <= max < 2^63 and precision in [1, 5]");
+        }
+        m_unit_shift = static_cast<unsigned>(std::bit_width(static_cast<std::uint64_t>(min)) - 1);
+        // half of the sub-bins covers the upper half of a power of two range, should be at least 10^precision
+        m_sub_bits = static_cast<unsigned>(std::ceil(std::log2(std::pow(10.0, precision)))) + 1;
+        m_counts.assign(bin_index(static_cast<std::uint64_t>(max) >> m_unit_shift) + 3, 0);
+    }
+
+    double min() const noexcept
+    { return m_min; }
+
+    double max() const noexcept
+    { return m_max; }
+
+    unsigned precision() const noexcept
+    { return m_precision; }
+
+    std::size_t bins() const noexcept
+    { return m_counts.size() - 2; }
+
+    std::uint64_t count(const std::size_t i) const noexcept
+    { return m_counts[i + 1]; }
+
+    // Bin i counts values in [lower(i), lower(i + 1))
+    double lower(const std::size_t i) const noexcept
+    {
+        const std::size_t sub_count = std::size_t{1} << m_sub_bits;
+        const std::size_t half = sub_count / 2;
+        if (i < sub_count) {
+            return std::ldexp(static_cast<double>(i), static_cast<int>(m_unit_shift));
+        }
+        const std::size_t b = i / half - 1;
+        const std::size_t sub = i - b * half;
+        return std::ldexp(static_cast<double>(sub), static_cast<int>(b + m_unit_shift));
+    }
+
+    std::uint64_t underflow() const noexcept
+    { return m_counts.front(); }
+
+    std::uint64_t overflow() const noexcept
+    { return m_counts.back(); }
+
+    std::uint64_t total() const noexcept
+    {
+        std::uint64_t sum = 0;
+        for (const std::uint64_t c : m_counts) {
+            sum += c;
+        }
+        return sum;
+    }
+
+    void add(const double value, const std::uint64_t count = 1) noexcept
+    { m_counts[slot(value)] += count; }
+
+    // Bin indices are computed for a chunk of values first and then the counts are incremented,
+    // so index computation doesn't depend on memory updates and can be vectorized
+    void add_batch(const std::span<const double> values) noexcept
+    {
+        constexpr std::size_t chunk = 64;
+        std::size_t slots[chunk];
+        for (std::size_t first = 0; first < values.size(); first += chunk) {
+            const std::size_t n = std::min(chunk, values.size() - first);
+            for (std::size_t i = 0; i < n; ++i) {
+                slots[i] = slot(values[first + i]);
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                ++m_counts[slots[i]];
+            }
+        }
+    }
+
+    // Throws std::invalid_argument if parameters differ
+    void merge(const log_linear_histogram& other)
+    {
+        if (other.m_min != m_min || other.m_max != m_max || other.m_precision != m_precision) {
+            throw std::invalid_argument("log_histogram: can't merge histograms with different parameters");
+        }
+        for (std::size_t i = 0; i < m_counts.size(); ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+    }
+
+    // Upper bound of the bin containing q-th (normalized rank in [0, 1]) value among values in [0, max],
+    // std::nullopt if there are no such values
+    std::optional<double> value_at_quantile(const double q) const
+    {
+        if (!(q >= 0.0 && q <= 1.0)) {
+            throw std::invalid_argument("log_histogram: quantile rank should be in [0, 1]");
+        }
+        const std::uint64_t in_range = total() - underflow() - overflow();
+        if (in_range == 0) {
+            return std::nullopt;
+        }
+        const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(in_range))));
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < bins(); ++i) {
+            cumulative += count(i);
+            if (cumulative >= target) {
+                return std::min(lower(i + 1), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    // 0 is underflow, bins() + 1 is overflow
+    std::size_t slot(const double value) const noexcept
+    {
+        const bool under = !(value >= 0.0);
+        const bool over = value > m_max;
+        const double clamped = under ? 0.0 : std::min(value, m_max);
+        // clamped < 2^63: signed conversion is a single instruction, unsigned one is not (before AVX-512)
+        const auto units = static_cast<std::uint64_t>(static_cast<std::int64_t>(clamped)) >> m_unit_shift;
+        const std::size_t index = bin_index(units) + 1;
+        return under ? 0 : over ? m_counts.size() - 1 : index;
+    }
+
+private:
+    // Power of two range b (0 for values below 2^sub_bits) is split into 2^(sub_bits - 1) bins
+    std::size_t bin_index(const std::uint64_t units) const noexcept
+    {
+        const std::uint64_t sub_mask = (std::uint64_t{1} << m_sub_bits) - 1;
+        const auto b = static_cast<unsigned>(std::bit_width(units | sub_mask)) - m_sub_bits;
+        return (static_cast<std::size_t>(b) << (m_sub_bits - 1)) + static_cast<std::size_t>(units >> b);
+    }
+
+    double m_min;
+    double m_max;
+    unsigned m_precision;
+    unsigned m_unit_shift;
+    unsigned m_sub_bits;
+    std::vector<std::uint64_t> m_counts; // underflow, bins..., overflow
+};
+
+} // namespace descend
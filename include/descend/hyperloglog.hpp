@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace descend {
+
+// HyperLogLog++ cardinality sketch over 64-bit hashes with 2^precision registers,
+// relative standard error is about 1.04 / sqrt(2^precision): 1.6% for precision 12, 0.8% for 14.
+//
+// Small cardinalities are kept in sparse representation: list of (index, rank) pairs with 25-bit index,
+// which is both more precise and much smaller than registers. It is converted into dense registers
+// (one byte each) when it would take more memory than them.
+//
+// Cardinality is estimated with the improved estimator by O. Ertl ("New cardinality estimation algorithms
+// for HyperLogLog sketches", 2017), it has no bias in the small range and doesn't need empirical bias tables.
+//
+// Sketches with the same precision can be merged, the result is the same as if all hashes were added to one sketch.
+class hyperloglog
+{
+public:
+    static constexpr unsigned min_precision = 4;
+    static constexpr unsigned max_precision = 18;
+
+    explicit hyperloglog(const unsigned precision = 14)
+        : m_precision(precision)
+    {
+        validate(precision);
+    }
+
+    // Throws std::invalid_argument if precision is out of [min_precision, max_precision]
+    static void validate(const unsigned precision)
+    {
+        if (precision < min_precision || precision > max_precision) {
+            throw std::invalid_argument("hyperloglog: precision should be in [4, 18]");
+        }
+    }
+
+    unsigned precision() const noexcept
+    { return m_precision; }
+
+    bool is_sparse() const noexcept
+    { return m_registers.empty(); }
+
+    // Approximate number of bytes used by the sketch
+    std::size_t memory_usage() const noexcept
+    {
+        return sizeof(*this) + m_sparse.capacity() * sizeof(std::uint32_t) + m_registers.capacity();
+    }
+
+    // Hash should be well mixed: all 64 bits are used
+    void add_hash(const std::uint64_t hash)
+    {
+        if (is_sparse()) {
+            const auto index = static_cast<std::uint32_t>(hash >> (64 - sparse_precision));
+            m_sparse.push_back((index << rank_bits) | rank(hash << sparse_precision, 64 - sparse_precision));
+            if (m_sparse.size() >= m_compact_at) {
+                compact();
+            }
+        }
+        else {
+            const auto index = static_cast<std::size_t>(hash >> (64 - m_precision));
+            auto& reg = m_registers[index];
+            reg = std::max(reg, rank(hash << m_precision, 64 - m_precision));
+        }
+    }
+
+    // Throws std::invalid_argument if precisions differ
+    void merge(const hyperloglog& other)
+    {
+        if (other.m_precision != m_precision) {
+            throw std::invalid_argument("hyperloglog: can't merge sketches with different precisions");
+        }
+        if (&other == this) {
+            return;
+        }
+        if (other.is_sparse()) {
+            for (const std::uint32_t entry : other.m_sparse) {
+                if (is_sparse()) {
+                    m_sparse.push_back(entry);
+                    if (m_sparse.size() >= m_compact_at) {
+                        compact();
+                    }
+                }
+                else {
+                    add_sparse_entry_to_registers(entry);
+                }
+            }
+        }
+        else {
+            to_dense();
+            merge_registers(m_registers.data(), other.m_registers.data(), m_registers.size());
+        }
+    }
+
+    double estimate() const
+    {
+        if (is_sparse()) {
+            // in sparse mode there are 2^25 registers with at most 'sparse_q + 1' rank
+            std::vector<std::uint32_t> entries = m_sparse;
+            compact_entries(entries);
+
+            std::uint64_t histogram[sparse_q + 2] = {};
+            histogram[0] = (std::uint64_t{1} << sparse_precision) - entries.size();
+            for (const std::uint32_t entry : entries) {
+                ++histogram[entry & rank_mask];
+            }
+            return ertl_estimate(histogram, sparse_precision, sparse_q);
+        }
+
+        std::uint64_t histogram[64 + 2] = {};
+        for (const std::uint8_t reg : m_registers) {
+            ++histogram[reg];
+        }
+        return ertl_estimate(histogram, m_precision, 64 - m_precision);
+    }
+
+private:
+    static constexpr unsigned sparse_precision = 25;
+    static constexpr unsigned sparse_q = 64 - sparse_precision;
+    static constexpr unsigned rank_bits = 6;
+    static constexpr std::uint32_t rank_mask = (1u << rank_bits) - 1;
+
+    // Position of the first 1 bit in the top 'bits' bits of 'value' (1-based), 'bits + 1' if they are all zero
+    static std::uint8_t rank(const std::uint64_t value, const unsigned bits) noexcept
+    {
+        const unsigned zeros = value == 0 ? 64u : static_cast<unsigned>(std::countl_zero(value));
+        return static_cast<std::uint8_t>(std::min(zeros, bits) + 1);
+    }
+
+    // Sorts entries and leaves single entry with the maximum rank for every index
+    static void compact_entries(std::vector<std::uint32_t>& entries)
+    {
+        std::sort(entries.begin(), entries.end());
+        // entries with the same index are adjacent and sorted by rank: keep the last one
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (i + 1 == entries.size() || (entries[i] >> rank_bits) != (entries[i + 1] >> rank_bits)) {
+                entries[out++] = entries[i];
+            }
+        }
+        entries.resize(out);
+    }
+
+    void compact()
+    {
+        compact_entries(m_sparse);
+        // sparse entries take 4 bytes, switch to one byte registers when they are more than half
+        // of that memory, so there is always room for appending before the next compaction
+        const std::size_t registers_count = std::size_t{1} << m_precision;
+        if (m_sparse.size() > registers_count / 8) {
+            to_dense();
+        }
+        else {
+            m_compact_at = std::min(registers_count / 4, 2 * m_sparse.size() + 16);
+        }
+    }
+
+    void add_sparse_entry_to_registers(const std::uint32_t entry) noexcept
+    {
+        const std::uint32_t sparse_index = entry >> rank_bits;
+        const unsigned extra_bits = sparse_precision - m_precision;
+        const auto index = static_cast<std::size_t>(sparse_index >> extra_bits);
+        const std::uint32_t rest = sparse_index & ((1u << extra_bits) - 1);
+
+        // rank in dense representation: leading zeros of the index bits below precision, then the sparse rank
+        const std::uint8_t r = rest != 0
+            ? rank(std::uint64_t{rest} << (64 - extra_bits), extra_bits)
+            : static_cast<std::uint8_t>(extra_bits + (entry & rank_mask));
+        m_registers[index] = std::max(m_registers[index], r);
+    }
+
+    void to_dense()
+    {
+        if (!is_sparse()) {
+            return;
+        }
+        m_registers.assign(std::size_t{1} << m_precision, 0);
+        for (const std::uint32_t entry : m_sparse) {
+            add_sparse_entry_to_registers(entry);
+        }
+        m_sparse.clear();
+        m_sparse.shrink_to_fit();
+    }
+
+    static void merge_registers(std::uint8_t* dst, const std::uint8_t* src, const std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 32 <= n; i += 32) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(a, b));
+        }
+#elif defined(__SSE2__)
+        for (; i + 16 <= n; i += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(a, b));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 16 <= n; i += 16) {
+            vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+        }
+#endif
+        for (; i < n; ++i) {
+            dst[i] = std::max(dst[i], src[i]);
+        }
+    }
+
+    static double sigma(double x) noexcept
+    {
+        if (x == 1.0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        double y = 1.0;
+        double z = x;
+        double z_prev;
+        do {
+            x *= x;
+            z_prev = z;
+            z += x * y;
+            y += y;
+        } while (z != z_prev);
+        return z;
+    }
+
+    static double tau(double x) noexcept
+    {
+        if (x == 0.0 || x == 1.0) {
+            return 0.0;
+        }
+        double y = 1.0;
+        double z = 1.0 - x;
+        double z_prev;
+        do {
+            x = std::sqrt(x);
+            z_prev = z;
+            y *= 0.5;
+            z -= (1.0 - x) * (1.0 - x) * y;
+        } while (z != z_prev);
+        return z / 3.0;
+    }
+
+    // histogram[k] is the number of registers with rank k, 0 <= k <= q + 1
+    static double ertl_estimate(const std::uint64_t* histogram, const unsigned p, const unsigned q) noexcept
+    {
+        const auto m = static_cast<double>(std::uint64_t{1} << p);
+        double z = m * tau(1.0 - static_cast<double>(histogram[q + 1]) / m);
+        for (unsigned k = q; k >= 1; --k) {
+            z = 0.5 * (z + static_cast<double>(histogram[k]));
+        }
+        z += m * sigma(static_cast<double>(histogram[0]) / m);
+
+        constexpr double alpha_inf = 0.721347520444481703680; // 1 / (2 ln 2)
+        return alpha_inf * m * m / z;
+    }
+
+    unsigned m_precision;
+    std::size_t m_compact_at = 16;
+    std::vector<std::uint32_t> m_sparse;
+    std::vector<std::uint8_t> m_registers;
+};
+
+} // namespace descend
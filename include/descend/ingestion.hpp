@@ -0,0 +1,328 @@
+#pragma once
+
+#include "descend/chain.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+
+// What ingestion_pipeline::push() does when the queue is full
+enum class overflow_policy
+{
+    block, // wait until the consumer frees a slot (backpressure)
+    drop,  // drop the element, push() returns false
+};
+
+struct ingest_options
+{
+    // Maximum number of elements waiting for the consumer, rounded up to a power of 2
+    std::size_t capacity = std::size_t{1} << 16;
+    overflow_policy overflow = overflow_policy::block;
+};
+
+namespace detail {
+
+// Bounded lock-free multi-producer single-consumer queue (D. Vyukov's bounded queue with per-slot sequence numbers):
+// a producer claims a position with CAS and publishes the element by the slot sequence,
+// the consumer takes elements in order of positions without atomic read-modify-write operations.
+template <class T>
+class mpsc_queue
+{
+    // producers and the consumer update their positions without sharing a cache line
+    static constexpr std::size_t cache_line_size = 64;
+
+public:
+    explicit mpsc_queue(const std::size_t capacity)
+        : m_mask(std::bit_ceil(capacity) - 1)
+        , m_slots(std::make_unique<slot[]>(m_mask + 1))
+    {
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator = (const mpsc_queue&) = delete;
+
+    ~mpsc_queue()
+    {
+        while (consume_one([] (T&&) {})) {}
+    }
+
+    // Returns false if the queue is full
+    template <class U>
+    bool try_push(U&& value)
+    {
+        std::uint64_t position = m_enqueue_position.load(std::memory_order_relaxed);
+        slot* s;
+        while (true) {
+            s = &m_slots[position & m_mask];
+            const std::uint64_t sequence = s->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(sequence - position);
+            if (diff == 0) {
+                if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                position = m_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(s->storage)) T((U&&) value);
+        s->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: passes the oldest element as T&& to f, returns false if the queue is empty
+    template <class F>
+    bool consume_one(F&& f)
+    {
+        slot& s = m_slots[m_dequeue_position & m_mask];
+        if (s.sequence.load(std::memory_order_acquire) != m_dequeue_position + 1) {
+            return false;
+        }
+        T* value = std::launder(reinterpret_cast<T*>(s.storage));
+        struct release_slot
+        {
+            slot& s;
+            T* value;
+            std::uint64_t next_sequence;
+
+            ~release_slot()
+            {
+                std::destroy_at(value);
+                s.sequence.store(next_sequence, std::memory_order_release);
+            }
+        } release{s, value, m_dequeue_position + m_mask + 1};
+        ++m_dequeue_position;
+        f(std::move(*value));
+        return true;
+    }
+
+    // Number of positions claimed by producers (including not published yet)
+    std::uint64_t claimed() const noexcept
+    { return m_enqueue_position.load(std::memory_order_acquire); }
+
+private:
+    struct slot
+    {
+        std::atomic<std::uint64_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    const std::size_t m_mask;
+    std::unique_ptr<slot[]> m_slots;
+    alignas(cache_line_size) std::atomic<std::uint64_t> m_enqueue_position{0};
+    alignas(cache_line_size) std::uint64_t m_dequeue_position = 0;
+};
+
+} // namespace detail
+
+// Thread-safe front end of a chain: many threads push() elements of type T into a bounded lock-free queue,
+// a single consumer thread owned by the object passes them to the chain (T&& input) in order of publication.
+// finish() stops the consumer and returns the result of the chain. Not movable (the consumer refers to it),
+// returned from ingestion() with guaranteed copy elision.
+template <class T, class Chain>
+class ingestion_pipeline
+{
+public:
+    using result_type = std::remove_cvref_t<detail::subchain_end_t<Chain>>;
+
+    ingestion_pipeline(Chain&& chain, const ingest_options& options)
+        : m_chain(std::move(chain))
+        , m_queue(options.capacity)
+        , m_overflow(options.overflow)
+    {
+        if (options.capacity == 0) {
+            throw std::invalid_argument("ingestion: capacity should be positive");
+        }
+        m_consumer = std::thread([this] { consume(); });
+    }
+
+    ingestion_pipeline(const ingestion_pipeline&) = delete;
+    ingestion_pipeline& operator = (const ingestion_pipeline&) = delete;
+
+    ~ingestion_pipeline()
+    {
+        stop();
+    }
+
+    // Thread-safe. Returns false if the element is dropped: the queue is full with overflow_policy::drop,
+    // the chain is done (e.g. take_n()) or failed with an exception, or finish() was called
+    template <class U = T>
+    bool push(U&& value)
+    {
+        if (m_closed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        while (true) {
+            // read before the attempt: the consumer changes it after freeing slots, so the wait can't miss them
+            const std::uint64_t processed = m_processed.load(std::memory_order_acquire);
+            if (m_queue.try_push((U&&) value)) {
+                break;
+            }
+            if (m_overflow == overflow_policy::drop || m_closed.load(std::memory_order_relaxed)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // the queue is full, so the consumer is awake; sleep instead of spinning to leave it the CPU
+            m_processed.wait(processed, std::memory_order_acquire);
+        }
+        wake_consumer();
+        return true;
+    }
+
+    // Number of elements dropped by push()
+    std::uint64_t dropped() const noexcept
+    { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Waits until all elements pushed before the call are processed by the chain
+    void flush()
+    {
+        const std::uint64_t target = m_queue.claimed();
+        std::uint64_t processed = m_processed.load(std::memory_order_acquire);
+        while (processed < target) {
+            m_processed.wait(processed, std::memory_order_acquire);
+            processed = m_processed.load(std::memory_order_acquire);
+        }
+    }
+
+    // Processes the remaining elements, stops the consumer and returns the result of the chain.
+    // Should be called once, after producers stopped pushing (later elements are dropped).
+    // Rethrows an exception thrown by the stages.
+    result_type finish()
+    {
+        stop();
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+        return m_chain.get(detail::index<0>{}).end();
+    }
+
+private:
+    static constexpr std::uint64_t progress_batch = 256;
+
+    void wake_consumer()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // only the first producer wakes the consumer: until it is scheduled, the others skip the syscall
+        if (m_consumer_sleeping.load(std::memory_order_relaxed) && m_consumer_sleeping.exchange(false, std::memory_order_relaxed)) {
+            m_wakeups.fetch_add(1, std::memory_order_relaxed);
+            m_wakeups.notify_one();
+        }
+    }
+
+    void stop()
+    {
+        if (m_consumer.joinable()) {
+            m_finishing.store(true, std::memory_order_relaxed);
+            m_wakeups.fetch_add(1, std::memory_order_seq_cst);
+            m_wakeups.notify_one();
+            m_consumer.join();
+            m_closed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void consume()
+    {
+        auto& head = m_chain.get(detail::index<0>{});
+        bool discard = false;
+        const auto process = [&] (T&& value) {
+            if (discard) {
+                return;
+            }
+            try {
+                head.process_incremental(std::move(value));
+                discard = head.done();
+            }
+            catch (...) {
+                m_error = std::current_exception();
+                discard = true;
+            }
+            if (discard) {
+                m_closed.store(true, std::memory_order_relaxed);
+            }
+        };
+
+        while (true) {
+            const std::uint64_t wakeups = m_wakeups.load(std::memory_order_relaxed);
+            const bool finishing = m_finishing.load(std::memory_order_acquire);
+            std::uint64_t count = 0;
+            // publish progress in bounded batches: blocked producers and flush() wait for it
+            while (count < progress_batch && m_queue.consume_one(process)) {
+                ++count;
+            }
+            if (count != 0) {
+                m_processed.fetch_add(count, std::memory_order_release);
+                m_processed.notify_all();
+                continue;
+            }
+            if (finishing) {
+                break;
+            }
+            m_consumer_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!m_queue.consume_one(process)) {
+                m_wakeups.wait(wakeups, std::memory_order_relaxed);
+            }
+            else {
+                m_processed.fetch_add(1, std::memory_order_release);
+                m_processed.notify_all();
+            }
+            m_consumer_sleeping.store(false, std::memory_order_relaxed);
+        }
+        // producers may still be blocked by the full queue, flush() should not wait anymore
+        m_closed.store(true, std::memory_order_relaxed);
+        m_processed.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_release);
+        m_processed.notify_all();
+    }
+
+    Chain m_chain;
+    detail::mpsc_queue<T> m_queue;
+    overflow_policy m_overflow;
+    std::exception_ptr m_error;
+
+    std::atomic<bool> m_closed{false};
+    std::atomic<bool> m_finishing{false};
+    std::atomic<bool> m_consumer_sleeping{false};
+    std::atomic<std::uint64_t> m_wakeups{0};
+    std::atomic<std::uint64_t> m_processed{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::thread m_consumer;
+};
+
+// Creates ingestion_pipeline for elements of type T processed by the stages, for many threads feeding one aggregation:
+//
+//      auto stats = dd::ingestion<Event>({.capacity = 1 << 16},
+//          dd::map_group_by<std::unordered_map>(&Event::endpoint, dd::transform(&Event::latency), dd::stats()));
+//      // request threads:
+//      stats.push(event);
+//      // at the end:
+//      auto result = stats.finish();
+//
+// Memory is bounded by options.capacity elements; when the queue is full push() waits or drops (options.overflow).
+// Include descend/ingestion.hpp separately and link with Threads::Threads.
+// Throws std::invalid_argument if options.capacity is 0.
+template <class T, class... Stages>
+auto ingestion(const ingest_options& options, Stages&&... stages)
+{
+    static_assert(!std::is_reference_v<T>, "ingestion<T>() elements are stored in the queue by value");
+    using chain_type = decltype(detail::make_subchain_for_input<T&&>((Stages&&) stages...));
+    return ingestion_pipeline<T, chain_type>{detail::make_subchain_for_input<T&&>((Stages&&) stages...), options};
+}
+
+} // namespace descend
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+
+// Vector-like container with fixed capacity N and in-place storage: never allocates
+// and is usable in constant evaluation.
+//
+// Unlike std::inplace_vector, elements are stored in T[N] array, so T is required to be
+// default constructible and N elements are always constructed. That keeps the container
+// a literal type in C++20 for any literal T.
+template <class T, std::size_t N>
+class inplace_vector
+{
+    static_assert(std::is_default_constructible_v<T>,
+            "inplace_vector requires default constructible value type");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr inplace_vector() = default;
+
+    static constexpr size_type capacity() noexcept
+    { return N; }
+    static constexpr size_type max_size() noexcept
+    { return N; }
+
+    constexpr size_type size() const noexcept
+    { return m_size; }
+    constexpr bool empty() const noexcept
+    { return m_size == 0; }
+    constexpr bool full() const noexcept
+    { return m_size == N; }
+
+    constexpr pointer data() noexcept
+    { return m_elems; }
+    constexpr const_pointer data() const noexcept
+    { return m_elems; }
+
+    constexpr iterator begin() noexcept
+    { return m_elems; }
+    constexpr const_iterator begin() const noexcept
+    { return m_elems; }
+    constexpr iterator end() noexcept
+    { return m_elems + m_size; }
+    constexpr const_iterator end() const noexcept
+    { return m_elems + m_size; }
+
+    constexpr reference operator [] (const size_type i) noexcept
+    { return m_elems[i]; }
+    constexpr const_reference operator [] (const size_type i) const noexcept
+    { return m_elems[i]; }
+
+    constexpr reference front() noexcept
+    { return m_elems[0]; }
+    constexpr const_reference front() const noexcept
+    { return m_elems[0]; }
+    constexpr reference back() noexcept
+    { return m_elems[m_size - 1]; }
+    constexpr const_reference back() const noexcept
+    { return m_elems[m_size - 1]; }
+
+    // Returns pointer to inserted element or nullptr if the container is full
+    template <class... Args>
+    constexpr pointer try_emplace_back(Args&&... args)
+    {
+        if (full()) {
+            return nullptr;
+        }
+        m_elems[m_size] = T((Args&&) args...);
+        return &m_elems[m_size++];
+    }
+
+    // Precondition: !full()
+    template <class... Args>
+    constexpr reference unchecked_emplace_back(Args&&... args)
+    {
+        m_elems[m_size] = T((Args&&) args...);
+        return m_elems[m_size++];
+    }
+
+    constexpr void pop_back() noexcept
+    {
+        m_elems[--m_size] = T();
+    }
+
+    constexpr void clear() noexcept
+    {
+        while (m_size != 0) {
+            pop_back();
+        }
+    }
+
+    friend constexpr bool operator == (const inplace_vector& lhs, const inplace_vector& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    T m_elems[N == 0 ? 1 : N] = {};
+    size_type m_size = 0;
+};
+
+} // namespace descend
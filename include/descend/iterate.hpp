@@ -3,6 +3,8 @@
 #include "descend/generator.hpp"
 #include "descend/helpers.hpp"
 
+#include <cstddef>
+#include <ranges>
 #include <unordered_map>
 #include <unordered_set>
 #include <type_traits>
@@ -51,6 +53,20 @@ struct iterate_output<T>
     using type = typename std::remove_cvref_t<T>::output_type;
 };
 
+// Custom sources (e.g. columns()) define their own iteration:
+//  * template <class Self> using output_type = ...;
+//      type of elements when source is iterated as Self (const Source&, Source&, Source&&)
+//  * template <class Self, class Done, class Callback> static void iterate(Self&& self, Done&& done, Callback&& callback);
+template <class T>
+concept CustomSource = requires { typename std::remove_cvref_t<T>::custom_source_tag; };
+
+template <class T>
+    requires CustomSource<T>
+struct iterate_output<T>
+{
+    using type = typename std::remove_cvref_t<T>::template output_type<T>;
+};
+
 template <class T>
 consteval bool has_begin_end() noexcept
 {
@@ -59,7 +75,7 @@ consteval bool has_begin_end() noexcept
     return requires (T t) { begin(t) != end(t); };
 }
 template <class T>
-    requires (has_begin_end<T>())
+    requires (has_begin_end<T>() && !CustomSource<T>)
 struct iterate_output<T>
 {
     consteval static auto value_type_helper() noexcept
@@ -117,8 +133,8 @@ using iterate_output_with_unwrap_t = iterate_output_t<unwrapped_input_t<T>>;
 
 
 
-template <class K, class V, class Done, class Callback>
-constexpr void iterate_like(std::unordered_map<K, V>&& range, Done&& done, Callback&& callback)
+template <class K, class V, class... Rest, class Done, class Callback>
+constexpr void iterate_like(std::unordered_map<K, V, Rest...>&& range, Done&& done, Callback&& callback)
 {
     while (!done() && !range.empty()) {
         auto handle = range.extract(range.begin());
@@ -126,8 +142,8 @@ constexpr void iterate_like(std::unordered_map<K, V>&& range, Done&& done, Callb
     }
 }
 
-template <class K, class V, class Done, class Callback>
-constexpr void iterate_like(std::unordered_set<K, V>&& range, Done&& done, Callback&& callback)
+template <class K, class... Rest, class Done, class Callback>
+constexpr void iterate_like(std::unordered_set<K, Rest...>&& range, Done&& done, Callback&& callback)
 {
     while (!done() && !range.empty()) {
         auto handle = range.extract(range.begin());
@@ -180,9 +196,25 @@ constexpr void iterate(Input&& input, Done&& done, Callback&& callback)
     if constexpr (is_specialization_of_v<generator, std::remove_cvref_t<range_type>>) {
         iterate_generator((range_type&&) range, (Done&&) done, (Callback&&) callback);
     }
+    else if constexpr (CustomSource<range_type>) {
+        std::remove_cvref_t<range_type>::iterate((range_type&&) range, (Done&&) done, (Callback&&) callback);
+    }
     else {
         iterate_like((range_type&&) range, (Done&&) done, (Callback&&) callback);
     }
 }
 
+
+// Number of elements in input if it is known before iteration (sized ranges and sources), used for size hints
+template <class Input>
+inline constexpr bool has_known_size_v = requires (Input&& input) {
+    std::ranges::size(unwrap_input((Input&&) input));
+};
+
+template <class Input>
+constexpr std::size_t known_size(Input&& input)
+{
+    return static_cast<std::size_t>(std::ranges::size(unwrap_input((Input&&) input)));
+}
+
 } // namespace descend::detail
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "descend/helpers.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace descend {
+
+// KLL quantile sketch (Karnin, Lang, Liberty, "Optimal Quantile Approximation in Streams", 2016).
+//
+// Elements are kept in levels of compactors, an element at level h stands for 2^h input elements.
+// When the sketch is over its capacity, the lowest full level is sorted and every second element
+// (starting from random offset) is promoted to the next level, the rest are dropped.
+// Level capacities decrease geometrically (by 2/3) from the top, so the memory is O(k) elements
+// regardless of the input size, and the normalized rank error is about 1.7 / k.
+//
+// Sketches with the same k can be merged, e.g. for sharded or parallel runs.
+// Minimum and maximum are tracked exactly.
+template <class T, class Compare = std::less<>>
+class kll_sketch
+{
+public:
+    explicit kll_sketch(const std::size_t k = 200, const std::uint64_t seed = 0, Compare compare = {})
+        : m_k(k), m_rng{seed}, m_compare(std::move(compare))
+    {
+        if (k < 8) {
+            throw std::invalid_argument("kll_sketch: k should be at least 8");
+        }
+        add_level();
+        m_levels.front().reserve(k);
+    }
+
+    std::size_t k() const noexcept
+    { return m_k; }
+
+    // Number of elements added, including merged sketches
+    std::uint64_t count() const noexcept
+    { return m_count; }
+
+    bool empty() const noexcept
+    { return m_count == 0; }
+
+    // Number of elements retained in the sketch
+    std::size_t retained() const noexcept
+    { return m_size; }
+
+    void add(const T& value)
+    {
+        update_min_max(value);
+        m_levels.front().push_back(value);
+        ++m_size;
+        ++m_count;
+        if (m_size >= m_capacity) {
+            compress();
+        }
+    }
+
+    // Throws std::invalid_argument if k differs
+    void merge(const kll_sketch& other)
+    {
+        if (other.m_k != m_k) {
+            throw std::invalid_argument("kll_sketch: can't merge sketches with different k");
+        }
+        if (&other == this || other.empty()) {
+            return;
+        }
+        update_min_max(*other.m_min);
+        update_min_max(*other.m_max);
+
+        while (m_levels.size() < other.m_levels.size()) {
+            add_level();
+        }
+        for (std::size_t h = 0; h < other.m_levels.size(); ++h) {
+            m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(), other.m_levels[h].end());
+        }
+        m_size += other.m_size;
+        m_count += other.m_count;
+        while (m_size >= m_capacity) {
+            compress();
+        }
+    }
+
+    // Element with normalized rank q in [0, 1]: quantile(0) is minimum, quantile(1) is maximum.
+    // Returns std::nullopt for empty sketch
+    std::optional<T> quantile(const double q) const
+    {
+        const auto result = quantiles(std::span<const double>(&q, 1));
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return result.front();
+    }
+
+    // Elements for every normalized rank in qs, empty vector for empty sketch.
+    // Throws std::invalid_argument if some q is outside of [0, 1]
+    std::vector<T> quantiles(const std::span<const double> qs) const
+    {
+        check_ranks(qs);
+        std::vector<T> result;
+        if (empty()) {
+            return result;
+        }
+
+        const auto sorted = sorted_weighted();
+        result.reserve(qs.size());
+        for (const double q : qs) {
+            if (q <= 0.0) {
+                result.push_back(*m_min);
+            }
+            else if (q >= 1.0) {
+                result.push_back(*m_max);
+            }
+            else {
+                // first element whose cumulative weight reaches q * count
+                const double target = q * static_cast<double>(m_count);
+                const auto it = std::lower_bound(sorted.begin(), sorted.end(), target,
+                        [] (const weighted& w, const double t) { return static_cast<double>(w.cumulative) < t; });
+                result.push_back(it == sorted.end() ? *m_max : it->value);
+            }
+        }
+        return result;
+    }
+
+    // Approximate fraction of added elements which are less than value
+    double rank(const T& value) const
+    {
+        if (empty()) {
+            return 0.0;
+        }
+        std::uint64_t less = 0;
+        for (std::size_t h = 0; h < m_levels.size(); ++h) {
+            for (const T& elem : m_levels[h]) {
+                if (m_compare(elem, value)) {
+                    less += std::uint64_t{1} << h;
+                }
+            }
+        }
+        return static_cast<double>(less) / static_cast<double>(m_count);
+    }
+
+    static void check_ranks(const std::span<const double> qs)
+    {
+        for (const double q : qs) {
+            if (!(q >= 0.0 && q <= 1.0)) {
+                throw std::invalid_argument("kll_sketch: quantile rank should be in [0, 1]");
+            }
+        }
+    }
+
+private:
+    struct weighted
+    {
+        T value;
+        std::uint64_t cumulative;
+    };
+
+    std::vector<weighted> sorted_weighted() const
+    {
+        std::vector<std::pair<T, std::uint64_t>> items;
+        items.reserve(m_size);
+        for (std::size_t h = 0; h < m_levels.size(); ++h) {
+            for (const T& elem : m_levels[h]) {
+                items.emplace_back(elem, std::uint64_t{1} << h);
+            }
+        }
+        std::sort(items.begin(), items.end(), [this] (const auto& lhs, const auto& rhs) {
+            return m_compare(lhs.first, rhs.first);
+        });
+
+        std::vector<weighted> sorted;
+        sorted.reserve(items.size());
+        std::uint64_t cumulative = 0;
+        for (auto& [value, weight] : items) {
+            cumulative += weight;
+            sorted.push_back({std::move(value), cumulative});
+        }
+        return sorted;
+    }
+
+    void update_min_max(const T& value)
+    {
+        if (!m_min.has_value() || m_compare(value, *m_min)) {
+            m_min = value;
+        }
+        if (!m_max.has_value() || m_compare(*m_max, value)) {
+            m_max = value;
+        }
+    }
+
+    // Capacity of level h (0 is the lowest) is k * (2/3)^(depth), depth counted from the top level,
+    // so capacities of all levels change when a new one is added
+    void add_level()
+    {
+        m_levels.emplace_back();
+        m_capacities.resize(m_levels.size());
+        m_capacity = 0;
+        for (std::size_t h = 0; h < m_levels.size(); ++h) {
+            const auto depth = static_cast<double>(m_levels.size() - 1 - h);
+            const auto capacity = static_cast<std::size_t>(std::ceil(static_cast<double>(m_k) * std::pow(2.0 / 3.0, depth)));
+            m_capacities[h] = std::max<std::size_t>(capacity, 2);
+            m_capacity += m_capacities[h];
+        }
+    }
+
+    // Compacts the lowest level which is over its capacity
+    void compress()
+    {
+        for (std::size_t h = 0; h < m_levels.size(); ++h) {
+            if (m_levels[h].size() < m_capacities[h]) {
+                continue;
+            }
+            if (h + 1 == m_levels.size()) {
+                add_level();
+            }
+
+            auto& level = m_levels[h];
+            auto& next = m_levels[h + 1];
+            std::sort(level.begin(), level.end(), m_compare);
+
+            // odd element stays at this level
+            const std::size_t kept = level.size() % 2;
+            const std::size_t offset = kept + static_cast<std::size_t>(m_rng() & 1);
+            for (std::size_t i = offset; i < level.size(); i += 2) {
+                next.push_back(std::move(level[i]));
+            }
+            const std::size_t promoted = (level.size() - kept) / 2;
+            level.resize(kept);
+            m_size -= promoted;
+            return;
+        }
+    }
+
+    std::size_t m_k;
+    detail::splitmix64 m_rng;
+    [[no_unique_address]]
+    Compare m_compare;
+    std::vector<std::vector<T>> m_levels;
+    std::vector<std::size_t> m_capacities;
+    std::size_t m_size = 0;
+    std::size_t m_capacity = 0; // sum of m_capacities
+    std::uint64_t m_count = 0;
+    std::optional<T> m_min;
+    std::optional<T> m_max;
+};
+
+} // namespace descend
@@ -0,0 +1,404 @@
+#pragma once
+
+#include "descend/stages/prefetch.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace descend {
+
+// Read-only memory mapping of a whole file, move-only.
+// Throws std::system_error if the file can't be opened or mapped.
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "mmap_records: can't open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap_records: can't stat " + path);
+        }
+        m_size = static_cast<std::size_t>(st.st_size);
+        if (m_size != 0) { // zero-length mappings are not allowed
+            void* address = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "mmap_records: can't map " + path);
+            }
+            m_data = static_cast<const std::byte*>(address);
+        }
+        ::close(fd); // the mapping keeps the file referenced
+    }
+
+    mapped_file(mapped_file&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+    {}
+
+    mapped_file& operator = (mapped_file&& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    ~mapped_file()
+    {
+        if (m_data != nullptr) {
+            ::munmap(const_cast<std::byte*>(m_data), m_size);
+        }
+    }
+
+    const std::byte* data() const noexcept
+    { return m_data; }
+
+    std::size_t size() const noexcept
+    { return m_size; }
+
+    // Hint to the kernel about the access pattern of bytes [offset, offset + length), e.g. MADV_SEQUENTIAL,
+    // MADV_WILLNEED. The range is extended to page boundaries, errors are ignored since it is only a hint
+    void advise(const std::size_t offset, const std::size_t length, const int advice) const noexcept
+    {
+        if (m_data == nullptr || length == 0) {
+            return;
+        }
+        static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t first = offset / page * page;
+        ::madvise(const_cast<std::byte*>(m_data + first), std::min(offset + length, m_size) - first, advice);
+    }
+
+private:
+    const std::byte* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+// Zone map of a record file: minimum and maximum of a key field for every block of 'block_records' records.
+// Blocks whose [min, max] doesn't intersect the requested range are skipped by mmap_records<T>().where().
+// Stored in a sidecar file with save()/load(), so it is built once per records file.
+template <class Key>
+class block_index
+{
+    static_assert(std::is_trivially_copyable_v<Key>, "block_index key should be trivially copyable");
+
+public:
+    block_index() = default;
+
+    // Throws std::invalid_argument if block_records is 0
+    template <class T, class Field>
+    static block_index build(const std::span<const T> records, Field&& field, const std::size_t block_records = 4096)
+    {
+        if (block_records == 0) {
+            throw std::invalid_argument("block_index: block_records should be positive");
+        }
+        block_index index;
+        index.m_header = header{magic, sizeof(T), key_type, block_records, records.size()};
+        for (std::size_t first = 0; first < records.size(); first += block_records) {
+            const std::size_t last = std::min(records.size(), first + block_records);
+            Key lo = std::invoke(field, records[first]);
+            Key hi = lo;
+            for (std::size_t i = first + 1; i < last; ++i) {
+                const Key key = std::invoke(field, records[i]);
+                lo = std::min(lo, key);
+                hi = std::max(hi, key);
+            }
+            index.m_zones.push_back({lo, hi});
+        }
+        return index;
+    }
+
+    // Throws std::system_error on I/O errors
+    void save(const std::string& path) const
+    {
+        const std::unique_ptr<std::FILE, int (*)(std::FILE*)> file{std::fopen(path.c_str(), "wb"), &std::fclose};
+        if (!file
+                || std::fwrite(&m_header, sizeof(m_header), 1, file.get()) != 1
+                || std::fwrite(m_zones.data(), sizeof(zone), m_zones.size(), file.get()) != m_zones.size()
+                || std::fflush(file.get()) != 0) {
+            throw std::system_error(errno, std::generic_category(), "block_index: can't write " + path);
+        }
+    }
+
+    // Throws std::system_error on I/O errors, std::invalid_argument if the file is not a block_index<Key>
+    static block_index load(const std::string& path)
+    {
+        const std::unique_ptr<std::FILE, int (*)(std::FILE*)> file{std::fopen(path.c_str(), "rb"), &std::fclose};
+        if (!file) {
+            throw std::system_error(errno, std::generic_category(), "block_index: can't open " + path);
+        }
+        block_index index;
+        if (std::fread(&index.m_header, sizeof(header), 1, file.get()) != 1
+                || index.m_header.magic != magic || index.m_header.key_type != key_type
+                || index.m_header.block_records == 0) {
+            throw std::invalid_argument("block_index: " + path + " is not a block index of this key type");
+        }
+        const std::uint64_t blocks = (index.m_header.record_count + index.m_header.block_records - 1) / index.m_header.block_records;
+        index.m_zones.resize(blocks);
+        if (std::fread(index.m_zones.data(), sizeof(zone), index.m_zones.size(), file.get()) != index.m_zones.size()) {
+            throw std::invalid_argument("block_index: " + path + " is truncated");
+        }
+        return index;
+    }
+
+    std::size_t record_size() const noexcept
+    { return m_header.record_size; }
+
+    std::size_t record_count() const noexcept
+    { return m_header.record_count; }
+
+    std::size_t block_records() const noexcept
+    { return m_header.block_records; }
+
+    std::size_t blocks() const noexcept
+    { return m_zones.size(); }
+
+    const Key& min(const std::size_t block) const noexcept
+    { return m_zones[block].min; }
+
+    const Key& max(const std::size_t block) const noexcept
+    { return m_zones[block].max; }
+
+    // false if block has no keys in [lo, hi]
+    bool may_contain(const std::size_t block, const Key& lo, const Key& hi) const noexcept
+    { return !(m_zones[block].max < lo) && !(hi < m_zones[block].min); }
+
+private:
+    static constexpr std::uint64_t magic = 0x3130504D5A444444; // "DDDZMP01"
+
+    // size and kind of the key, so the file isn't read with a different key type of the same size
+    static constexpr std::uint64_t key_type = sizeof(Key)
+        | std::uint64_t{std::is_floating_point_v<Key>} << 32
+        | std::uint64_t{std::is_signed_v<Key>} << 33;
+
+    struct header
+    {
+        std::uint64_t magic = 0;
+        std::uint64_t record_size = 0;
+        std::uint64_t key_type = 0;
+        std::uint64_t block_records = 0;
+        std::uint64_t record_count = 0;
+    };
+
+    struct zone
+    {
+        Key min;
+        Key max;
+    };
+
+    header m_header;
+    std::vector<zone> m_zones;
+};
+
+namespace detail {
+
+// Records are processed sequentially, the CPU is asked to load the record this far ahead (in bytes)
+inline constexpr std::size_t mmap_prefetch_distance = 512;
+
+// Output is const T& or const T&& (see mapped_records::output_type)
+template <class Output, class T, class Done, class Callback>
+void iterate_mapped_records(const T* first, const T* last, Done& done, Callback& callback)
+{
+    for (const T* record = first; record != last && !done(); ++record) {
+        stages::prefetch_address(reinterpret_cast<const std::byte*>(record) + mmap_prefetch_distance);
+        callback(static_cast<Output>(*record));
+    }
+}
+
+template <class T, class Records, class Field, class Key>
+struct filtered_records_source;
+
+} // namespace detail
+
+// Records of trivially copyable type T stored in a file back to back (e.g. written with fwrite),
+// mapped into memory. It is a source yielding const T& directly from the mapping without copying or parsing,
+// with exact size hint. The object owns the mapping and is move-only.
+// Temporary source (e.g. dd::apply(dd::mmap_records<T>(path), ...)) unmaps the file when the computation ends,
+// so it yields const T&& like std::move(range) does, and *_ref stages reject it.
+// Throws std::system_error if the file can't be mapped, std::invalid_argument if its size is not a multiple of sizeof(T).
+template <class T>
+class mapped_records
+{
+    static_assert(std::is_trivially_copyable_v<T>, "mmap_records<T> requires trivially copyable T");
+
+public:
+    using custom_source_tag = void;
+
+    template <class Self>
+    using output_type = std::conditional_t<std::is_lvalue_reference_v<Self>, const T&, const T&&>;
+
+    explicit mapped_records(const std::string& path)
+        : m_file(path)
+    {
+        if (m_file.size() % sizeof(T) != 0) {
+            throw std::invalid_argument("mmap_records: size of " + path + " is not a multiple of the record size");
+        }
+        m_file.advise(0, m_file.size(), MADV_SEQUENTIAL);
+    }
+
+    std::size_t size() const noexcept
+    { return m_file.size() / sizeof(T); }
+
+    // mmap() returns page-aligned address, so records are aligned if alignof(T) <= page size
+    std::span<const T> records() const noexcept
+    { return {reinterpret_cast<const T*>(m_file.data()), size()}; }
+
+    const mapped_file& file() const noexcept
+    { return m_file; }
+
+    // Source yielding only records with lo <= field(record) <= hi.
+    // With 'index' (built for this file and the same field) blocks whose key range doesn't intersect [lo, hi]
+    // are skipped without touching their pages, otherwise all records are checked.
+    // The source refers to this object (and 'index') if it is an lvalue, takes ownership of the mapping otherwise.
+    // Throws std::invalid_argument if the index was built for a different file.
+    template <class Field, class Key = std::remove_cvref_t<std::invoke_result_t<Field&, const T&>>>
+    auto where(Field field, const std::type_identity_t<Key>& lo, const std::type_identity_t<Key>& hi,
+               const block_index<Key>* index = nullptr) const &
+    {
+        check_index(index);
+        return detail::filtered_records_source<T, const mapped_records*, Field, Key>{this, std::move(field), lo, hi, index};
+    }
+
+    template <class Field, class Key = std::remove_cvref_t<std::invoke_result_t<Field&, const T&>>>
+    auto where(Field field, const std::type_identity_t<Key>& lo, const std::type_identity_t<Key>& hi,
+               const block_index<Key>* index = nullptr) &&
+    {
+        check_index(index);
+        return detail::filtered_records_source<T, mapped_records, Field, Key>{std::move(*this), std::move(field), lo, hi, index};
+    }
+
+    template <class Self, class Done, class Callback>
+    static void iterate(Self&& self, Done&& done, Callback&& callback)
+    {
+        const auto records = self.records();
+        detail::iterate_mapped_records<output_type<Self&&>>(records.data(), records.data() + records.size(), done, callback);
+    }
+
+private:
+    template <class Key>
+    void check_index(const block_index<Key>* index) const
+    {
+        if (index != nullptr && (index->record_size() != sizeof(T) || index->record_count() != size())) {
+            throw std::invalid_argument("mmap_records: block index was built for a different file");
+        }
+    }
+
+    mapped_file m_file;
+};
+
+namespace detail {
+
+// Source produced by mapped_records::where(), Records is either a pointer to mapped_records or mapped_records itself.
+// Records are yielded as const T&& when the source owns the mapping and is iterated as rvalue (see mapped_records)
+template <class T, class Records, class Field, class Key>
+struct filtered_records_source
+{
+    using custom_source_tag = void;
+
+    template <class Self>
+    using output_type = std::conditional_t<std::is_lvalue_reference_v<Self> || std::is_pointer_v<Records>, const T&, const T&&>;
+
+    Records records_storage;
+    Field field;
+    Key lo;
+    Key hi;
+    const block_index<Key>* index;
+
+    const mapped_records<T>& mapped() const noexcept
+    {
+        if constexpr (std::is_pointer_v<Records>) {
+            return *records_storage;
+        }
+        else {
+            return records_storage;
+        }
+    }
+
+    // Blocks which are going to be read, all records are one block without index
+    std::vector<std::size_t> selected_blocks() const
+    {
+        std::vector<std::size_t> blocks;
+        if (index == nullptr) {
+            if (mapped().size() != 0) {
+                blocks.push_back(0);
+            }
+            return blocks;
+        }
+        for (std::size_t b = 0; b < index->blocks(); ++b) {
+            if (index->may_contain(b, lo, hi)) {
+                blocks.push_back(b);
+            }
+        }
+        return blocks;
+    }
+
+    template <class Self, class Done, class Callback>
+    static void iterate(Self&& self, Done&& done, Callback&& callback)
+    {
+        const auto records = self.mapped().records();
+        const std::size_t block_records = self.index != nullptr ? self.index->block_records() : records.size();
+        const std::vector<std::size_t> blocks = self.selected_blocks();
+
+        const auto block_range = [&] (const std::size_t b) {
+            const std::size_t first = b * block_records;
+            return std::pair{first, std::min(records.size(), first + block_records)};
+        };
+        auto filter = [&self, &callback] (const T& record) {
+            const Key& key = std::invoke(self.field, record);
+            if (!(key < self.lo) && !(self.hi < key)) {
+                callback(static_cast<output_type<Self&&>>(record));
+            }
+        };
+
+        for (std::size_t i = 0; i < blocks.size() && !done(); ++i) {
+            // the next block is not adjacent in general, ask the kernel to read it ahead
+            if (i + 1 < blocks.size() && blocks[i + 1] != blocks[i] + 1) {
+                const auto [first, last] = block_range(blocks[i + 1]);
+                self.mapped().file().advise(first * sizeof(T), (last - first) * sizeof(T), MADV_WILLNEED);
+            }
+            const auto [first, last] = block_range(blocks[i]);
+            iterate_mapped_records<const T&>(records.data() + first, records.data() + last, done, filter);
+        }
+    }
+};
+
+} // namespace detail
+
+// Maps the file with records of trivially copyable T (see mapped_records), POSIX only:
+//
+//      auto trades = dd::mmap_records<Trade>("trades.bin");
+//      dd::apply(trades, dd::transform(&Trade::price), dd::sum_precise());
+//
+// Selective scans by a field skip whole blocks with a zone map built once and kept in a sidecar file:
+//
+//      dd::block_index<std::int64_t>::build(trades.records(), &Trade::ts).save("trades.bin.ts");
+//      const auto index = dd::block_index<std::int64_t>::load("trades.bin.ts");
+//      dd::apply(trades.where(&Trade::ts, from, to, &index), ...);
+template <class T>
+mapped_records<T> mmap_records(const std::string& path)
+{
+    return mapped_records<T>{path};
+}
+
+} // namespace descend
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+namespace detail {
+
+// Packed keys are used for grouping by several fields at once.
+// Every field is encoded into a fixed number of bytes, so the whole key is std::array<unsigned char, N>:
+// * hashing and equality work on the contiguous bytes instead of member-by-member
+// * lexicographic byte comparison (memcmp) gives the same order as comparing fields one by one
+//
+// Encodings:
+// * unsigned integers - big-endian
+// * signed integers   - big-endian with flipped sign bit, so negative values go first
+// * enums             - as underlying type
+// * bool              - single byte
+// * packed_string<N>  - N bytes zero-padded + 1 byte of length, so "a" < "a\0" < "ab"
+
+template <class T>
+struct packed_integral_field
+{
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+            "packed_key supports integral and enum fields, use packed_string<N>() for strings");
+
+    using value_type = T;
+    static constexpr std::size_t size = sizeof(T);
+
+    template <class Int>
+    static constexpr auto as_unsigned(const Int value) noexcept
+    {
+        if constexpr (std::is_enum_v<Int>) {
+            return as_unsigned(static_cast<std::underlying_type_t<Int>>(value));
+        }
+        else if constexpr (std::is_same_v<Int, bool>) {
+            return static_cast<unsigned char>(value);
+        }
+        else {
+            using unsigned_type = std::make_unsigned_t<Int>;
+            auto u = static_cast<unsigned_type>(value);
+            if constexpr (std::is_signed_v<Int>) {
+                u ^= static_cast<unsigned_type>(unsigned_type{1} << (sizeof(Int) * 8 - 1));
+            }
+            return u;
+        }
+    }
+
+    static constexpr void encode(const T value, unsigned char* out) noexcept
+    {
+        const auto u = as_unsigned(value);
+        for (std::size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<unsigned char>(u >> ((size - 1 - i) * 8));
+        }
+    }
+
+    static constexpr T decode(const unsigned char* in) noexcept
+    {
+        if constexpr (std::is_enum_v<T>) {
+            return static_cast<T>(packed_integral_field<std::underlying_type_t<T>>::decode(in));
+        }
+        else if constexpr (std::is_same_v<T, bool>) {
+            return in[0] != 0;
+        }
+        else {
+            using unsigned_type = std::make_unsigned_t<T>;
+            unsigned_type u = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                u = static_cast<unsigned_type>((u << 8) | in[i]);
+            }
+            if constexpr (std::is_signed_v<T>) {
+                u ^= static_cast<unsigned_type>(unsigned_type{1} << (sizeof(T) * 8 - 1));
+            }
+            return static_cast<T>(u);
+        }
+    }
+};
+
+template <std::size_t N>
+struct packed_string_field
+{
+    static_assert(N > 0 && N < 256, "packed_string<N> supports 0 < N < 256");
+
+    using value_type = std::string;
+    static constexpr std::size_t size = N + 1;
+
+    static constexpr void encode(const std::string_view value, unsigned char* out)
+    {
+        if (value.size() > N) {
+            throw std::length_error("packed_key: string does not fit into packed_string<N>");
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            out[i] = i < value.size() ? static_cast<unsigned char>(value[i]) : 0;
+        }
+        out[N] = static_cast<unsigned char>(value.size());
+    }
+
+    static constexpr std::string decode(const unsigned char* in)
+    {
+        std::string result(in[N], '\0');
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            result[i] = static_cast<char>(in[i]);
+        }
+        return result;
+    }
+};
+
+// Projection marked to be packed as a string of at most N chars
+template <std::size_t N, class Projection>
+struct packed_string_projection
+{
+    using field_type = packed_string_field<N>;
+
+    [[no_unique_address]]
+    Projection projection;
+};
+
+template <class T>
+inline constexpr bool is_packed_string_projection_v = false;
+template <std::size_t N, class Projection>
+inline constexpr bool is_packed_string_projection_v<packed_string_projection<N, Projection>> = true;
+
+template <class Projection, class Input>
+struct packed_field_for
+{
+    using type = packed_integral_field<std::remove_cvref_t<std::invoke_result_t<const Projection&, Input>>>;
+};
+template <std::size_t N, class Projection, class Input>
+struct packed_field_for<packed_string_projection<N, Projection>, Input>
+{
+    using type = packed_string_field<N>;
+};
+template <class Projection, class Input>
+using packed_field_for_t = typename packed_field_for<Projection, Input>::type;
+
+template <class Projection, class Input>
+constexpr decltype(auto) invoke_packed_projection(const Projection& projection, Input&& input)
+{
+    if constexpr (is_packed_string_projection_v<Projection>) {
+        return std::invoke(projection.projection, (Input&&) input);
+    }
+    else {
+        return std::invoke(projection, (Input&&) input);
+    }
+}
+
+template <class... Fields>
+struct packed_key_value
+{
+    static constexpr std::size_t size = (Fields::size + ... + 0);
+
+    std::array<unsigned char, size> bytes = {};
+
+    // std::array<unsigned char> comparisons are lexicographic on unsigned bytes, which is memcmp order
+    friend constexpr bool operator == (const packed_key_value&, const packed_key_value&) = default;
+    friend constexpr auto operator <=> (const packed_key_value&, const packed_key_value&) = default;
+
+    // Decodes all fields back, strings are decoded to std::string
+    constexpr auto unpack() const
+    {
+        return unpack_impl(std::index_sequence_for<Fields...>{});
+    }
+
+private:
+    template <std::size_t I>
+    static constexpr std::size_t offset() noexcept
+    {
+        constexpr std::size_t sizes[] = {Fields::size..., 0};
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < I; ++i) {
+            result += sizes[i];
+        }
+        return result;
+    }
+
+    template <std::size_t... Is>
+    constexpr auto unpack_impl(std::index_sequence<Is...>) const
+    {
+        return std::tuple<typename Fields::value_type...>{Fields::decode(bytes.data() + offset<Is>())...};
+    }
+};
+
+// Key getter producing packed_key_value from several projections.
+// map_group_by calls unpack_key() when emitting groups, so key fields are passed further
+// as separate arguments: args<Field1, Field2, ..., chain results...>
+template <class... Projections>
+struct packed_key_getter
+{
+    std::tuple<Projections...> projections;
+
+    template <class Input>
+    constexpr auto operator () (const Input& input) const
+    {
+        using key_type = packed_key_value<packed_field_for_t<Projections, const Input&>...>;
+        key_type key;
+        encode_fields<0>(key.bytes.data(), input);
+        return key;
+    }
+
+    template <class... Fields>
+    static constexpr auto unpack_key(const packed_key_value<Fields...>& key)
+    {
+        return key.unpack();
+    }
+
+private:
+    template <std::size_t I, class Input>
+    constexpr void encode_fields(unsigned char* out, const Input& input) const
+    {
+        if constexpr (I < sizeof...(Projections)) {
+            using projection_type = std::tuple_element_t<I, std::tuple<Projections...>>;
+            using field_type = packed_field_for_t<projection_type, const Input&>;
+
+            field_type::encode(invoke_packed_projection(std::get<I>(projections), input), out);
+            encode_fields<I + 1>(out + field_type::size, input);
+        }
+    }
+};
+
+// Hash of the bytes: short keys are mixed from 64-bit words, longer ones are hashed as std::string_view
+struct packed_key_hash
+{
+    static constexpr std::uint64_t mix(std::uint64_t x) noexcept
+    {
+        // splitmix64 finalizer
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    template <std::size_t N>
+    static constexpr std::uint64_t load_word(const std::array<unsigned char, N>& bytes, const std::size_t from) noexcept
+    {
+        std::uint64_t word = 0;
+        for (std::size_t i = from; i < from + 8 && i < N; ++i) {
+            word = (word << 8) | bytes[i];
+        }
+        return word;
+    }
+
+    template <class... Fields>
+    std::size_t operator () (const packed_key_value<Fields...>& key) const noexcept
+    {
+        constexpr std::size_t size = packed_key_value<Fields...>::size;
+        if constexpr (size <= 16) {
+            const std::uint64_t lo = load_word(key.bytes, 0);
+            const std::uint64_t hi = load_word(key.bytes, 8);
+            return static_cast<std::size_t>(mix(lo ^ mix(hi + size)));
+        }
+        else {
+            const auto view = std::string_view{reinterpret_cast<const char*>(key.bytes.data()), size};
+            return std::hash<std::string_view>{}(view);
+        }
+    }
+};
+
+} // namespace detail
+
+// Marks projection result (anything convertible to std::string_view) to be packed
+// into packed_key as a string of at most N chars. Longer strings throw std::length_error.
+template <std::size_t N, class Projection>
+constexpr auto packed_string(Projection&& projection)
+{
+    return detail::packed_string_projection<N, std::remove_cvref_t<Projection>>{(Projection&&) projection};
+}
+
+// Key getter for map_group_by, packing several fixed-width fields into one contiguous key.
+// Groups are emitted with key fields decoded back into separate arguments:
+//
+//      dd::map_group_by<std::unordered_map>(
+//              dd::packed_key(&Event::user_id, &Event::kind, dd::packed_string<8>(&Event::country)),
+//              dd::count()),
+//      dd::for_each([] (std::int32_t user_id, std::int16_t kind, std::string country, std::size_t count) { ... })
+template <class... Projections>
+constexpr auto packed_key(Projections&&... projections)
+{
+    static_assert(sizeof...(Projections) != 0, "packed_key requires at least one projection");
+    return detail::packed_key_getter<std::remove_cvref_t<Projections>...>{
+        std::tuple<std::remove_cvref_t<Projections>...>{(Projections&&) projections...}};
+}
+
+} // namespace descend
+
+template <class... Fields>
+struct std::hash<descend::detail::packed_key_value<Fields...>> : descend::detail::packed_key_hash
+{ };
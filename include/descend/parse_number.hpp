@@ -0,0 +1,126 @@
+#pragma once
+
+#include "descend/error_or.hpp"
+
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace descend {
+namespace detail {
+
+// 8 ASCII digits as little-endian 64-bit word: first digit in the lowest byte
+inline std::uint64_t load_eight_digits(const char* first) noexcept
+{
+    std::uint64_t word;
+    std::memcpy(&word, first, 8);
+    return word;
+}
+
+// All 8 bytes are in ['0', '9']: high nibble is 3 and adding 6 doesn't carry into it
+constexpr bool are_eight_digits(const std::uint64_t word) noexcept
+{
+    return ((word & 0xF0F0F0F0F0F0F0F0) | (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+        == 0x3333333333333333;
+}
+
+// Value of 8 digits with 3 multiplications instead of 8 dependent ones (SIMD within a register)
+constexpr std::uint32_t parse_eight_digits(std::uint64_t word) noexcept
+{
+    constexpr std::uint64_t mask = 0x000000FF000000FF;
+    constexpr std::uint64_t mul1 = 100 + (1000000ULL << 32);
+    constexpr std::uint64_t mul2 = 1 + (10000ULL << 32);
+    word -= 0x3030303030303030;
+    word = (word * 10) + (word >> 8); // pairs of digits in even bytes
+    return static_cast<std::uint32_t>(((word & mask) * mul1 + ((word >> 16) & mask) * mul2) >> 32);
+}
+
+template <class T>
+inline constexpr bool has_swar_parse =
+       std::integral<T> && !std::same_as<T, bool>
+    && std::endian::native == std::endian::little;
+
+// Fixed-width field of exactly 8 or 16 digits (e.g. zero padded), optionally with '-' for signed types.
+// Returns false if it is not such a field, then std::from_chars is used
+template <class T>
+bool parse_fixed_width_swar(const std::string_view str, T& value, bool& out_of_range) noexcept
+{
+    const bool negative = std::is_signed_v<T> && !str.empty() && str.front() == '-';
+    const char* digits = str.data() + negative;
+    const std::size_t len = str.size() - negative;
+
+    std::uint64_t magnitude;
+    if (len == 8) {
+        const std::uint64_t word = load_eight_digits(digits);
+        if (!are_eight_digits(word)) {
+            return false;
+        }
+        magnitude = parse_eight_digits(word);
+    }
+    else if (len == 16) {
+        const std::uint64_t high = load_eight_digits(digits);
+        const std::uint64_t low = load_eight_digits(digits + 8);
+        if (!(are_eight_digits(high) & are_eight_digits(low))) {
+            return false;
+        }
+        magnitude = std::uint64_t{parse_eight_digits(high)} * 100000000 + parse_eight_digits(low);
+    }
+    else {
+        return false;
+    }
+
+    using unsigned_type = std::make_unsigned_t<T>;
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + negative;
+    out_of_range = magnitude > limit;
+    const auto bits = static_cast<unsigned_type>(magnitude);
+    value = static_cast<T>(negative ? static_cast<unsigned_type>(0 - bits) : bits);
+    return true;
+}
+
+// Parses the whole 'str' into 'value', returns std::errc{} on success
+template <class T>
+std::errc parse_number_to(const std::string_view str, T& value) noexcept
+{
+    if constexpr (has_swar_parse<T>) {
+        bool out_of_range = false;
+        if (parse_fixed_width_swar(str, value, out_of_range)) {
+            return out_of_range ? std::errc::result_out_of_range : std::errc{};
+        }
+    }
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec == std::errc{} && ptr != str.data() + str.size()) {
+        return std::errc::invalid_argument;
+    }
+    return ec;
+}
+
+template <class T>
+error_or<T> make_parse_result(const std::errc ec, const T value) noexcept
+{
+    return ec == std::errc{}
+        ? error_or<T>{in_place_value, value}
+        : error_or<T>{in_place_error, std::make_error_code(ec)};
+}
+
+} // namespace detail
+
+// Parses the whole 'str' as a number of type T in the format of std::from_chars (decimal, no leading '+' or spaces).
+// Errors are std::errc::invalid_argument (not a number or trailing characters) and std::errc::result_out_of_range.
+// Fixed-width integer fields of 8 or 16 digits are parsed with SWAR: 8 digits are validated
+// and converted with a few 64-bit operations instead of a loop over characters.
+template <class T>
+error_or<T> parse_number(const std::string_view str) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "parse_number<T> requires arithmetic T");
+    T value{};
+    const std::errc ec = detail::parse_number_to(str, value);
+    return detail::make_parse_result(ec, value);
+}
+
+} // namespace descend
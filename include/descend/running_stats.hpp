@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace descend {
+
+// Count, mean and central moment sums M2 (and M3, M4 if MaxMoment is 4) of a stream of values,
+// updated with Welford's method (extended to higher moments by Terriberry), which doesn't suffer
+// from catastrophic cancellation of the naive sum of squares.
+// Statistics of separate parts (shards, chunks) are combined with merge() using pairwise formulas
+// of Chan et al. and Pebay, the result is the same (up to rounding) as if all values were added to one object.
+// Undefined statistics (e.g. variance of empty input) are NaN.
+template <int MaxMoment = 2>
+class running_stats
+{
+    static_assert(MaxMoment == 2 || MaxMoment == 4, "running_stats supports MaxMoment 2 (variance) or 4 (skewness, kurtosis)");
+
+public:
+    static constexpr int max_moment = MaxMoment;
+
+    constexpr running_stats() = default;
+
+    // Statistics of a chunk computed directly: central moment sums about its mean
+    constexpr running_stats(const std::uint64_t count, const double mean, const double m2,
+                            const double m3 = 0.0, const double m4 = 0.0) noexcept
+        : m_count(count), m_mean(mean), m_m2(m2), m_m3(m3), m_m4(m4)
+    {}
+
+    constexpr void add(const double x) noexcept
+    {
+        const double n1 = static_cast<double>(m_count);
+        ++m_count;
+        const double n = static_cast<double>(m_count);
+        const double delta = x - m_mean;
+        const double delta_n = delta / n;
+        const double term = delta * delta_n * n1;
+        m_mean += delta_n;
+        if constexpr (MaxMoment == 4) {
+            const double delta_n2 = delta_n * delta_n;
+            m_m4 += term * delta_n2 * (n * n - 3.0 * n + 3.0) + 6.0 * delta_n2 * m_m2 - 4.0 * delta_n * m_m3;
+            m_m3 += term * delta_n * (n - 2.0) - 3.0 * delta_n * m_m2;
+        }
+        m_m2 += term;
+    }
+
+    constexpr void merge(const running_stats& other) noexcept
+    {
+        if (other.m_count == 0) {
+            return;
+        }
+        if (m_count == 0) {
+            *this = other;
+            return;
+        }
+        const double na = static_cast<double>(m_count);
+        const double nb = static_cast<double>(other.m_count);
+        const double n = na + nb;
+        const double delta = other.m_mean - m_mean;
+        const double delta2 = delta * delta;
+
+        const double m2 = m_m2 + other.m_m2 + delta2 * na * nb / n;
+        if constexpr (MaxMoment == 4) {
+            const double m3 = m_m3 + other.m_m3
+                + delta2 * delta * na * nb * (na - nb) / (n * n)
+                + 3.0 * delta * (na * other.m_m2 - nb * m_m2) / n;
+            const double m4 = m_m4 + other.m_m4
+                + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+                + 6.0 * delta2 * (na * na * other.m_m2 + nb * nb * m_m2) / (n * n)
+                + 4.0 * delta * (na * other.m_m3 - nb * m_m3) / n;
+            m_m3 = m3;
+            m_m4 = m4;
+        }
+        m_mean += delta * nb / n;
+        m_m2 = m2;
+        m_count += other.m_count;
+    }
+
+    constexpr std::uint64_t count() const noexcept
+    { return m_count; }
+
+    constexpr double mean() const noexcept
+    { return m_count == 0 ? std::numeric_limits<double>::quiet_NaN() : m_mean; }
+
+    constexpr double m2() const noexcept
+    { return m_m2; }
+
+    // Population variance: M2 / n
+    constexpr double variance() const noexcept
+    { return m_m2 / static_cast<double>(m_count); }
+
+    // Unbiased sample variance: M2 / (n - 1)
+    constexpr double sample_variance() const noexcept
+    { return m_count < 2 ? std::numeric_limits<double>::quiet_NaN() : m_m2 / static_cast<double>(m_count - 1); }
+
+    double stddev() const noexcept
+    { return std::sqrt(variance()); }
+
+    double sample_stddev() const noexcept
+    { return std::sqrt(sample_variance()); }
+
+    constexpr double m3() const noexcept
+        requires (MaxMoment == 4)
+    { return m_m3; }
+
+    constexpr double m4() const noexcept
+        requires (MaxMoment == 4)
+    { return m_m4; }
+
+    // Population skewness: sqrt(n) * M3 / M2^1.5
+    double skewness() const noexcept
+        requires (MaxMoment == 4)
+    { return std::sqrt(static_cast<double>(m_count)) * m_m3 / std::pow(m_m2, 1.5); }
+
+    // Population excess kurtosis: n * M4 / M2^2 - 3
+    constexpr double kurtosis() const noexcept
+        requires (MaxMoment == 4)
+    { return static_cast<double>(m_count) * m_m4 / (m_m2 * m_m2) - 3.0; }
+
+private:
+    std::uint64_t m_count = 0;
+    double m_mean = 0.0;
+    double m_m2 = 0.0;
+    double m_m3 = 0.0;
+    double m_m4 = 0.0;
+};
+
+} // namespace descend
@@ -6,6 +6,8 @@
 #include "descend/iterate.hpp"
 #include "descend/stage_styles.hpp"
 #include "descend/stages/accumulate.hpp" // IWYU pragma: export
+#include "descend/stages/prefetch.hpp"   // IWYU pragma: export
+#include "descend/stages/to_static.hpp"  // IWYU pragma: export
 #include "descend/stages/transform.hpp"  // IWYU pragma: export
 
 #include <algorithm>
@@ -15,6 +17,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace descend {
 namespace detail::stages {
@@ -143,6 +146,12 @@ struct take_n_stage
                 --n;
             }
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t size, Next&& next)
+        {
+            next.size_hint(size < n ? size : n);
+        }
         constexpr bool done() const
         {
             return n == 0;
@@ -191,6 +200,14 @@ struct to_stage
                 out.insert(out.end(), value_type{(Args&&) args...});
             }, (Input&&) input);
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&&)
+        {
+            if constexpr (requires { out.reserve(n); }) {
+                out.reserve(n);
+            }
+        }
         template <class Next>
         constexpr decltype(auto) end(Next&& next)
         {
@@ -206,6 +223,125 @@ struct to_stage
 };
 
 
+// Collects args<A, B, C> stream into struct-of-arrays std::tuple<Cont<A>, Cont<B>, Cont<C>>,
+// every argument is appended to its own column. Single-argument input gives std::tuple<Cont<T>>.
+template <template <class...> class Cont>
+struct to_columns_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_complete;
+
+    template <class Input>
+    struct impl
+    {
+        static constexpr auto make_columns(Input&& input)
+        {
+            return args_invoke([] <class... Args> (Args&&...) {
+                return std::tuple<Cont<finalize_result_t<Args, false>>...>{}; // keep reference wrappers as is
+            }, (Input&&) input);
+        }
+
+        using input_type = Input;
+        using output_type = decltype(make_columns(std::declval<Input>()));
+        using stage_type = to_columns_stage;
+
+        output_type out = {};
+
+        template <class Next>
+        constexpr void process_incremental(Input&& input, Next&&)
+        {
+            args_invoke([this] <class... Args> (Args&&... args) {
+                std::apply([&] (auto&... columns) {
+                    (columns.insert(columns.end(), (Args&&) args), ...);
+                }, out);
+            }, (Input&&) input);
+        }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&&)
+        {
+            std::apply([n] (auto&... columns) {
+                const auto reserve = [n] (auto& column) {
+                    if constexpr (requires { column.reserve(n); }) {
+                        column.reserve(n);
+                    }
+                };
+                (reserve(columns), ...);
+            }, out);
+        }
+
+        template <class Next>
+        constexpr decltype(auto) end(Next&& next)
+        {
+            return next.process_complete(std::move(out));
+        }
+    };
+
+    template <class Input>
+    constexpr auto make_impl()
+    {
+        return impl<Input>{};
+    }
+};
+
+
+// Appends elements into caller-owned container, which is cleared when the chain is created.
+// Outputs std::reference_wrapper<Cont>, so the capacity of the container survives between runs.
+//
+// Every chain created from the stage writes into the same container, so it is rejected inside map_group_by.
+// In group_by the container holds only the current group and is cleared when the next one starts.
+template <class Cont>
+struct into_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_complete;
+    static constexpr bool shares_caller_state = true;
+
+    std::reference_wrapper<Cont> container;
+
+    template <class Input>
+    struct impl
+    {
+        using input_type = Input;
+        using output_type = std::reference_wrapper<Cont>;
+        using stage_type = into_stage;
+
+        std::reference_wrapper<Cont> out;
+
+        template <class Next>
+        constexpr void process_incremental(Input&& input, Next&&)
+        {
+            args_invoke([this] <class... Args> (Args&&... args) {
+                using value_type = typename Cont::value_type;
+                static_assert(std::is_constructible_v<value_type, Args&&...>,
+                        "Can't construct value type of a container from input arguments");
+
+                Cont& cont = out.get();
+                cont.insert(cont.end(), value_type{(Args&&) args...});
+            }, (Input&&) input);
+        }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&&)
+        {
+            if constexpr (requires { out.get().reserve(n); }) {
+                out.get().reserve(n);
+            }
+        }
+        template <class Next>
+        constexpr decltype(auto) end(Next&& next)
+        {
+            return next.process_complete(std::reference_wrapper<Cont>{out});
+        }
+    };
+
+    template <class Input>
+    constexpr auto make_impl()
+    {
+        container.get().clear();
+        return impl<Input>{container};
+    }
+};
+
+
 template <class F>
 struct for_each_stage
 {
@@ -311,6 +447,12 @@ struct expand_stage
         {
             next.process_incremental(expand_to_args((Input&&) input));
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
     };
 
     template <class Input>
@@ -382,6 +524,12 @@ struct zip_result_stage
         {
             next.process_incremental(do_zip_result(f, (Input&&) input));
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
     };
 
     template <class Input>
@@ -540,6 +688,12 @@ struct swizzle_stage
         {
             next.process_incremental(swizzle((Input&&) input));
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
     };
 
     template <class Input>
@@ -581,6 +735,12 @@ struct transform_arg_stage
         {
             next.process_incremental(transform_one_arg<Index>((Input&&) input, f));
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
     };
 
     template <class Input>
@@ -652,6 +812,12 @@ struct unwrap_optional_stage
                 carrier = std::nullopt;
             }
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
         constexpr bool done() const
         {
             return !carrier.has_value();
@@ -794,6 +960,12 @@ struct enumerate_stage
             next.process_incremental(add_index(current, (Input&&) input));
             ++current;
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
     };
 
     template <class Input>
@@ -826,6 +998,17 @@ constexpr auto to()
 {
     return detail::stages::to_stage<Cont>{};
 };
+template <template <class...> class Cont = std::vector>
+constexpr auto to_columns()
+{
+    return detail::stages::to_columns_stage<Cont>{};
+}
+template <class Cont>
+constexpr auto into(std::reference_wrapper<Cont> container)
+{
+    static_assert(!std::is_const_v<Cont>, "into() requires non-const container, use std::ref()");
+    return detail::stages::into_stage<Cont>{container};
+}
 template <class F>
 constexpr auto for_each(F&& f)
 {
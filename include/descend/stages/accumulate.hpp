@@ -7,12 +7,17 @@
 #include <cstddef>
 #include <functional>
 #include <optional>
+#include <ranges>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace descend {
 namespace detail::stages {
 
+// Default Finish for base_accumulate_stage: accumulated value is the result
+struct no_finish {};
+
 // Provide base implementation for different accumulate stages,
 // reducing the amount of boilerplate code needed for incremental->complete stages
 //
@@ -21,9 +26,19 @@ namespace detail::stages {
 // UpdateOp should provide operator() (Init& init, Input&& input)
 // to update init with input
 //
+// Finish (optional) should provide operator() (Init&& init) to convert accumulated value into the result,
+// e.g. sort collected elements or compute estimate from a sketch
+//
+// UpdateOp may also provide update_random_access(Init& init, std::size_t size, Element&& element)
+// for complete random access input, element(i) returns i-th element as Input.
+// Then the chain passes the whole input at once instead of element by element (see process_random_access()),
+// so UpdateOp may skip elements without touching them, e.g. in sampling.
+// Along with it UpdateOp may provide update_contiguous(Init& init, const T* data, std::size_t size),
+// which is called instead when the input is a contiguous range, e.g. for explicit SIMD loops
+//
 // DisplayStage is used for debug printing stage, otherwise all stages would be base_accumulate_stage,
 // which is not very informative
-template <class DisplayStage, class MakeInit, class UpdateOp>
+template <class DisplayStage, class MakeInit, class UpdateOp, class Finish = no_finish>
 struct base_accumulate_stage
 {
     static constexpr auto style = stage_styles::incremental_to_complete;
@@ -32,43 +47,88 @@ struct base_accumulate_stage
     MakeInit make_init;
     [[no_unique_address]]
     UpdateOp update_op;
+    [[no_unique_address]]
+    Finish finish;
 
     template <class Input>
     struct impl
     {
+        using accumulated_type = decltype(std::declval<MakeInit>().template operator () <Input> ());
+
+        static constexpr auto output_type_helper() noexcept
+        {
+            if constexpr (std::is_same_v<Finish, no_finish>) {
+                return std::type_identity<accumulated_type>{};
+            }
+            else {
+                return std::type_identity<std::invoke_result_t<Finish&, accumulated_type&&>>{};
+            }
+        }
+
         using input_type = Input;
-        using output_type = decltype(std::declval<MakeInit>().template operator () <Input> ());
+        using output_type = typename decltype(output_type_helper())::type;
         using stage_type = base_accumulate_stage; // for processing style
         using display_stage_type = DisplayStage; // for output in debug
 
         [[no_unique_address]]
-        output_type output;
+        accumulated_type output;
 
         [[no_unique_address]]
         UpdateOp update_op;
 
+        [[no_unique_address]]
+        Finish finish;
+
         template <class Next>
         constexpr void process_incremental(Input&& input, Next&&)
         {
             update_op(output, (Input&&) input);
         }
+        template <class Range, class Next, class Op = UpdateOp>
+            requires (   std::ranges::random_access_range<std::remove_reference_t<Range>>
+                      && std::ranges::sized_range<std::remove_reference_t<Range>>
+                      && requires (Op& op, accumulated_type& accum, Input (*element)(std::size_t)) {
+                             op.update_random_access(accum, std::size_t{}, element);
+                         })
+        constexpr void process_random_access(Range&& range, Next&&)
+        {
+            const auto size = static_cast<std::size_t>(std::ranges::size(range));
+            if constexpr (   std::ranges::contiguous_range<std::remove_reference_t<Range>>
+                          && requires (Op& op) { op.update_contiguous(output, std::ranges::data(range), size); }) {
+                update_op.update_contiguous(output, std::ranges::data(range), size);
+            }
+            else {
+                using difference_type = std::ranges::range_difference_t<std::remove_reference_t<Range>>;
+                const auto first = std::ranges::begin(range);
+                const auto element = [&first] (const std::size_t i) -> Input {
+                    return forward_like<Range>(first[static_cast<difference_type>(i)]);
+                };
+                update_op.update_random_access(output, size, element);
+            }
+        }
+
         template <class Next>
         constexpr auto end(Next&& next)
         {
-            return next.process_complete(std::forward<output_type>(output));
+            if constexpr (std::is_same_v<Finish, no_finish>) {
+                return next.process_complete(std::forward<accumulated_type>(output));
+            }
+            else {
+                return next.process_complete(std::invoke(finish, std::move(output)));
+            }
         }
     };
 
     template <class Input>
     constexpr auto make_impl() &
     {
-        return impl<Input>{ make_init.template operator () <Input> (), update_op };
+        return impl<Input>{ make_init.template operator () <Input> (), update_op, finish };
     }
 
     template <class Input>
     constexpr auto make_impl() &&
     {
-        return impl<Input>{ ((MakeInit &&) make_init).template operator () <Input> (), (UpdateOp&&) update_op };
+        return impl<Input>{ ((MakeInit &&) make_init).template operator () <Input> (), (UpdateOp&&) update_op, (Finish&&) finish };
     }
 };
 
@@ -76,7 +136,25 @@ template <class DisplayStage, class MakeInit, class UpdateOp>
 constexpr auto make_base_accumulate_stage(MakeInit&& make_init, UpdateOp&& update_op)
 {
     return base_accumulate_stage<DisplayStage, MakeInit, UpdateOp>{
-            (MakeInit&&) make_init, (UpdateOp&&) update_op};
+            (MakeInit&&) make_init, (UpdateOp&&) update_op, {}};
+}
+
+template <class DisplayStage, class MakeInit, class UpdateOp, class Finish>
+constexpr auto make_base_accumulate_stage(MakeInit&& make_init, UpdateOp&& update_op, Finish&& finish)
+{
+    return base_accumulate_stage<DisplayStage, MakeInit, UpdateOp, Finish>{
+            (MakeInit&&) make_init, (UpdateOp&&) update_op, (Finish&&) finish};
+}
+
+// *_ref stages keep references to the processed elements instead of copies.
+// It is only safe when elements outlive the pipeline: iterating lvalue range or std::ref(range).
+// Values (generators, transform results) and rvalue references (std::move(range)) are rejected.
+template <class Input>
+consteval void check_stable_reference_input()
+{
+    static_assert(std::is_lvalue_reference_v<Input>,
+            "*_ref stages require lvalue reference input which outlives the pipeline: "
+            "iterate lvalue range or std::ref(range), or use non-ref version of the stage");
 }
 
 } // namespace detail::stages
@@ -202,6 +280,125 @@ constexpr auto min_max(Compare&& compare = {})
             std::move(make_init), std::move(update_op));
 }
 
+// Same as min(), but does not copy elements: outputs std::optional<std::reference_wrapper<const T>>
+// referring to minimum element. Requires elements to outlive the pipeline (see check_stable_reference_input()).
+template <class Compare = std::less<>>
+constexpr auto min_ref(Compare&& compare = {})
+{
+    auto make_init = [] <class Input> ()
+    {
+        detail::stages::check_stable_reference_input<Input>();
+        return std::optional<std::reference_wrapper<const std::remove_cvref_t<Input>>>{};
+    };
+
+    auto update_op = [compare = (Compare&&) compare] <class MaybeMin, class Input> (MaybeMin& min, Input&& input)
+    {
+        if (!min.has_value() || compare(std::as_const(input), min->get())) {
+            min.emplace(std::as_const(input));
+        }
+    };
+
+    return detail::stages::make_base_accumulate_stage<struct min_ref_stage>(
+            std::move(make_init), std::move(update_op));
+}
+
+// Same as max(), but does not copy elements: outputs std::optional<std::reference_wrapper<const T>>
+// referring to maximum element. Requires elements to outlive the pipeline (see check_stable_reference_input()).
+template <class Compare = std::less<>>
+constexpr auto max_ref(Compare&& compare = {})
+{
+    auto make_init = [] <class Input> ()
+    {
+        detail::stages::check_stable_reference_input<Input>();
+        return std::optional<std::reference_wrapper<const std::remove_cvref_t<Input>>>{};
+    };
+
+    auto update_op = [compare = (Compare&&) compare] <class MaybeMax, class Input> (MaybeMax& max, Input&& input)
+    {
+        if (!max.has_value() || compare(max->get(), std::as_const(input))) {
+            max.emplace(std::as_const(input));
+        }
+    };
+
+    return detail::stages::make_base_accumulate_stage<struct max_ref_stage>(
+            std::move(make_init), std::move(update_op));
+}
+
+// Same as min_max(), but does not copy elements: outputs std::optional of struct with 2 members: min and max,
+// both being std::reference_wrapper<const T>. Requires elements to outlive the pipeline.
+template <class Compare = std::less<>>
+constexpr auto min_max_ref(Compare&& compare = {})
+{
+    auto make_init = [] <class Input> ()
+    {
+        detail::stages::check_stable_reference_input<Input>();
+        using ref_type = std::reference_wrapper<const std::remove_cvref_t<Input>>;
+        struct min_max { ref_type min, max; };
+        return std::optional<min_max>{};
+    };
+
+    auto update_op = [compare = (Compare&&) compare] <class MaybeMinMax, class Input> (MaybeMinMax& mm, Input&& input)
+    {
+        if (!mm.has_value()) {
+            mm.emplace(std::as_const(input), std::as_const(input));
+        }
+        else {
+            if (compare(std::as_const(input), mm->min.get())) {
+                mm->min = std::as_const(input);
+            }
+            if (compare(mm->max.get(), std::as_const(input))) {
+                mm->max = std::as_const(input);
+            }
+        }
+    };
+
+    return detail::stages::make_base_accumulate_stage<struct min_max_ref_stage>(
+            std::move(make_init), std::move(update_op));
+}
+
+// Outputs std::vector<std::reference_wrapper<const T>> with (at most) k greatest elements according to Compare,
+// sorted from the greatest. Keeps min-heap of k references, so elements are never copied.
+// Requires elements to outlive the pipeline (see check_stable_reference_input()).
+template <class Compare = std::less<>>
+constexpr auto top_k_ref(const std::size_t k, Compare&& compare = {})
+{
+    auto make_init = [k] <class Input> ()
+    {
+        detail::stages::check_stable_reference_input<Input>();
+        std::vector<std::reference_wrapper<const std::remove_cvref_t<Input>>> heap;
+        heap.reserve(k);
+        return heap;
+    };
+
+    // 'greater' makes std heap functions keep the smallest of top k elements in front
+    auto greater = [compare = (Compare&&) compare] (const auto& lhs, const auto& rhs)
+    {
+        return compare(rhs.get(), lhs.get());
+    };
+
+    auto update_op = [k, greater] <class Heap, class Input> (Heap& heap, Input&& input)
+    {
+        if (heap.size() < k) {
+            heap.emplace_back(std::as_const(input));
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+        else if (k != 0 && greater(std::cref(input), heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            heap.back() = std::as_const(input);
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+    };
+
+    auto finish = [greater] <class Heap> (Heap heap)
+    {
+        std::sort_heap(heap.begin(), heap.end(), greater);
+        return heap;
+    };
+
+    return detail::stages::make_base_accumulate_stage<struct top_k_ref_stage>(
+            std::move(make_init), std::move(update_op), std::move(finish));
+}
+
 // outputs the number of elements received as std::size_t
 constexpr auto count()
 {
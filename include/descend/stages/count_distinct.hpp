@@ -0,0 +1,63 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/helpers.hpp"
+#include "descend/hyperloglog.hpp"
+#include "descend/stages/accumulate.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+namespace detail::stages {
+
+template <class Display, class Hash, class Finish>
+constexpr auto make_hyperloglog_stage(const unsigned precision, Hash&& hash, Finish&& finish)
+{
+    hyperloglog::validate(precision); // throws on invalid precision when the stage is created
+
+    auto make_init = [precision] <class Input> ()
+    {
+        static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>>,
+                "count_distinct stages accept single argument, use make_pair()/make_tuple() stages for multiple arguments");
+        return hyperloglog{precision};
+    };
+    auto update_op = [hash = (Hash&&) hash] <class Input> (hyperloglog& sketch, Input&& input)
+    {
+        sketch.add_hash(static_cast<std::uint64_t>(std::invoke(hash, std::as_const(input))));
+    };
+
+    return make_base_accumulate_stage<Display>(std::move(make_init), std::move(update_op), (Finish&&) finish);
+}
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Outputs approximate number of distinct elements as std::size_t using HyperLogLog++ sketch
+// with 2^precision registers (see hyperloglog), relative error is about 1.04 / sqrt(2^precision).
+// Hash should return well mixed 64-bit value for const Input&.
+// Memory doesn't depend on the number of elements, small groups in map_group_by take only a few bytes.
+template <class Hash = detail::mixed_std_hash>
+constexpr auto count_distinct_approx(const unsigned precision = 14, Hash&& hash = {})
+{
+    return detail::stages::make_hyperloglog_stage<struct count_distinct_approx_stage>(
+            precision, (Hash&&) hash,
+            [] (hyperloglog&& sketch) { return static_cast<std::size_t>(std::llround(sketch.estimate())); });
+}
+
+// Outputs hyperloglog sketch itself, sketches from different runs (e.g. shards) can be merged
+// and estimated later
+template <class Hash = detail::mixed_std_hash>
+constexpr auto hyperloglog_sketch(const unsigned precision = 14, Hash&& hash = {})
+{
+    return detail::stages::make_hyperloglog_stage<struct hyperloglog_sketch_stage>(
+            precision, (Hash&&) hash, [] (hyperloglog&& sketch) { return std::move(sketch); });
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "descend/stage_styles.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+
+// Result of a chain with deadline() stage: 'truncated' is set if some elements were dropped
+// because the deadline expired, so 'value' is computed over a prefix of the input
+template <class T>
+struct deadline_result
+{
+    T value;
+    bool truncated = false;
+
+    constexpr bool complete() const noexcept { return !truncated; }
+
+    constexpr bool operator == (const deadline_result&) const = default;
+};
+
+template <>
+struct deadline_result<void>
+{
+    bool truncated = false;
+
+    constexpr bool complete() const noexcept { return !truncated; }
+
+    constexpr bool operator == (const deadline_result&) const = default;
+};
+
+namespace detail::stages {
+
+// Limit is Clock::duration (time budget counted from creation of the chain) or Clock::time_point
+template <class Clock, class Limit>
+struct deadline_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_incremental;
+
+    Limit limit;
+    std::size_t check_every;
+
+    template <class Callable>
+    static constexpr auto wrap_result(const bool truncated, Callable&& callable)
+    {
+        using callable_result_type = std::invoke_result_t<Callable&&>;
+        if constexpr (std::is_void_v<callable_result_type>) {
+            std::invoke((Callable&&) callable);
+            return deadline_result<void>{truncated};
+        }
+        else {
+            return deadline_result<std::remove_cvref_t<callable_result_type>>{std::invoke((Callable&&) callable), truncated};
+        }
+    }
+
+    typename Clock::time_point expires_at() const
+    {
+        if constexpr (std::is_same_v<Limit, typename Clock::duration>) {
+            return Clock::now() + limit;
+        }
+        else {
+            return limit;
+        }
+    }
+
+    template <class Input>
+    struct impl
+    {
+        using input_type = Input;
+        using output_type = Input;
+        using stage_type = deadline_stage;
+
+        typename Clock::time_point at;
+        std::size_t check_every;
+        std::size_t until_check = 0; // the clock is checked on the first element
+        bool expired = false;
+        bool truncated = false;
+
+        template <class Next>
+        constexpr void process_incremental(Input&& input, Next&& next)
+        {
+            if (until_check == 0) {
+                // the element is dropped, so 'truncated' is never set when the input just ended in time,
+                // or when the next stages didn't need more elements anyway (e.g. take_n())
+                if (expired || Clock::now() >= at) {
+                    expired = true;
+                    truncated = truncated || !next.done();
+                    return;
+                }
+                until_check = check_every;
+            }
+            --until_check;
+            next.process_incremental((Input&&) input);
+        }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
+        template <class Next>
+        constexpr bool done(const Next& next) const
+        {
+            return expired || next.done();
+        }
+
+        template <class Next>
+        constexpr auto end(Next&& next)
+        {
+            return deadline_stage::wrap_result(truncated, [&next] () -> decltype(auto) { return next.end(); });
+        }
+    };
+
+    template <class Input>
+    auto make_impl() const
+    {
+        return impl<Input>{expires_at(), check_every};
+    }
+};
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Stops the computation when the time budget is exhausted and returns a partial result instead of missing the deadline:
+//
+//      auto top = dd::apply(rows, dd::deadline(50ms), dd::filter(matches), dd::to<std::vector>());
+//      if (top.truncated) { ... }
+//
+// The budget is counted from creation of the chain (inside map_group_by or tee: of the group's chain).
+// The clock (std::chrono::steady_clock) is read once per 'check_every' elements, so expensive elements
+// may overrun the deadline by up to check_every - 1 of them.
+// The result of the next stages is wrapped into deadline_result<T> with the 'truncated' flag, which is not set
+// when the next stages are done (e.g. take_n()) before the deadline cuts the input.
+// Throws std::invalid_argument if check_every is 0.
+template <class Rep, class Period>
+auto deadline(const std::chrono::duration<Rep, Period> budget, const std::size_t check_every = 64)
+{
+    using clock = std::chrono::steady_clock;
+    if (check_every == 0) {
+        throw std::invalid_argument("deadline: check_every should be positive");
+    }
+    return detail::stages::deadline_stage<clock, clock::duration>{std::chrono::ceil<clock::duration>(budget), check_every};
+}
+
+// Same with absolute time point of any clock with static now()
+template <class Clock, class Duration>
+auto deadline(const std::chrono::time_point<Clock, Duration> at, const std::size_t check_every = 64)
+{
+    if (check_every == 0) {
+        throw std::invalid_argument("deadline: check_every should be positive");
+    }
+    return detail::stages::deadline_stage<Clock, typename Clock::time_point>{
+        std::chrono::ceil<typename Clock::duration>(at), check_every};
+}
+
+} // namespace stages
+} // namespace descend
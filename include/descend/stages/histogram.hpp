@@ -0,0 +1,130 @@
+#pragma once
+
+#include "descend/helpers.hpp"
+#include "descend/histogram.hpp"
+#include "descend/stages/accumulate.hpp"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail::stages {
+
+// Collects values into a small buffer and adds them to the histogram in batches
+template <class Histogram>
+struct batched_histogram
+{
+    static constexpr std::size_t buffer_capacity = 64;
+
+    Histogram histogram;
+    std::array<double, buffer_capacity> buffer = {};
+    std::size_t buffered = 0;
+
+    void flush() noexcept
+    {
+        histogram.add_batch(std::span<const double>(buffer.data(), buffered));
+        buffered = 0;
+    }
+};
+
+template <class Input>
+consteval void check_histogram_input()
+{
+    static_assert(std::is_arithmetic_v<std::remove_cvref_t<Input>>,
+            "histogram stages accept single arithmetic argument");
+}
+
+struct histogram_update
+{
+    template <class Histogram, class Input>
+    void operator () (Histogram& hist, Input&& input) const noexcept
+    {
+        check_histogram_input<Input>();
+        hist.add(static_cast<double>(input));
+    }
+
+    template <class Histogram, class Input>
+    void operator () (batched_histogram<Histogram>& hist, Input&& input) const noexcept
+    {
+        check_histogram_input<Input>();
+        hist.buffer[hist.buffered++] = static_cast<double>(input);
+        if (hist.buffered == hist.buffer.size()) {
+            hist.flush();
+        }
+    }
+};
+
+struct histogram_finish
+{
+    template <class Histogram>
+    Histogram operator () (Histogram&& hist) const noexcept
+    {
+        return std::move(hist);
+    }
+
+    template <class Histogram>
+    Histogram operator () (batched_histogram<Histogram>&& hist) const noexcept
+    {
+        hist.flush();
+        return std::move(hist.histogram);
+    }
+};
+
+// Batches of log_linear_histogram are binned with SIMD only if there are vector lzcnt and double -> int64
+// conversion, otherwise buffering is slower than adding values one by one
+#if defined(__AVX512CD__) && defined(__AVX512DQ__)
+inline constexpr bool batch_log_histogram = true;
+#else
+inline constexpr bool batch_log_histogram = false;
+#endif
+
+// Accumulator is Histogram itself or batched_histogram<Histogram> if Batched
+template <class Display, bool Batched, class Histogram>
+auto make_histogram_stage(Histogram&& prototype)
+{
+    auto make_init = [prototype = (Histogram&&) prototype] <class Input> ()
+    {
+        if constexpr (Batched) {
+            return batched_histogram<std::remove_cvref_t<Histogram>>{prototype};
+        }
+        else {
+            return prototype;
+        }
+    };
+    return make_base_accumulate_stage<Display>(std::move(make_init), histogram_update{}, histogram_finish{});
+}
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Outputs fixed_bin_histogram of arithmetic input with bins [edges[i], edges[i + 1]),
+// values outside of the edges are counted as underflow/overflow. Bin is found with branchless binary search.
+// Throws std::invalid_argument if edges are not strictly increasing or there are less than 2 of them.
+inline auto histogram(std::vector<double> edges)
+{
+    return detail::stages::make_histogram_stage<struct histogram_stage, false>(fixed_bin_histogram{std::move(edges)});
+}
+
+inline auto histogram(const std::initializer_list<double> edges)
+{
+    return histogram(std::vector<double>(edges));
+}
+
+// Outputs log_linear_histogram (HdrHistogram-like) of non-negative arithmetic input (latencies, sizes)
+// in [0, max] with 'precision' significant decimal digits, see log_linear_histogram for details.
+// With AVX-512 values are buffered and binned in batches of 64, which the compiler vectorizes.
+// Per key distributions: map_group_by<Map>(key_getter, transform(...), log_histogram(1, 1e9, 3))
+inline auto log_histogram(const double min, const double max, const unsigned precision)
+{
+    return detail::stages::make_histogram_stage<struct log_histogram_stage, detail::stages::batch_log_histogram>(
+            log_linear_histogram{min, max, precision});
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/helpers.hpp"
+#include "descend/stage_styles.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+
+// Counters of memoize_transform() cache, updated while the chain runs
+struct memoize_counters
+{
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+};
+
+namespace detail {
+
+// String-like arguments are stored as std::string and looked up as std::string_view,
+// so string_view inputs don't dangle and don't allocate on a hit
+template <class T>
+inline constexpr bool is_memo_string_v =
+    !std::is_arithmetic_v<std::remove_cvref_t<T>> && std::is_convertible_v<T, std::string_view>;
+
+template <class T>
+using memo_key_element_t = std::conditional_t<is_memo_string_v<T>, std::string, std::remove_cvref_t<T>>;
+
+template <class T>
+constexpr decltype(auto) memo_view(const T& value) noexcept
+{
+    if constexpr (is_memo_string_v<const T&>) {
+        return std::string_view(value);
+    }
+    else {
+        return (value);
+    }
+}
+
+// Set-associative cache with CLOCK eviction: a key can be only in one bucket of 'ways' slots
+// (open addressing bounded by the bucket), so lookup compares at most 'ways' hashes.
+// When the bucket is full, its clock hand clears 'referenced' bits until it finds an entry
+// which wasn't used since the last sweep. Approximates LRU without reordering on hits.
+template <class Key, class Value>
+class clock_cache
+{
+public:
+    static constexpr std::size_t ways = 8;
+
+    // Throws std::invalid_argument if capacity is 0
+    explicit clock_cache(const std::size_t capacity)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("memoize_transform: capacity should be positive");
+        }
+        m_bucket_mask = std::bit_ceil((capacity + ways - 1) / ways) - 1;
+        const std::size_t slots = (m_bucket_mask + 1) * ways;
+        m_hashes.assign(slots, 0);
+        m_referenced.assign(slots, 0);
+        m_entries.resize(slots);
+        m_hands.assign(m_bucket_mask + 1, 0);
+    }
+
+    std::size_t capacity() const noexcept
+    { return m_entries.size(); }
+
+    // Pointer to the value of the entry with 'hash' for which key_equal(key) is true, nullptr if there is none
+    template <class KeyEqual>
+    const Value* find(const std::uint64_t hash, KeyEqual&& key_equal) noexcept
+    {
+        const std::size_t first = bucket(hash) * ways;
+        for (std::size_t i = first; i < first + ways; ++i) {
+            if (m_hashes[i] == hash && m_entries[i] && key_equal(m_entries[i]->first)) {
+                m_referenced[i] = 1;
+                return &m_entries[i]->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Returns true if an entry was evicted
+    bool insert(const std::uint64_t hash, Key&& key, Value&& value)
+    {
+        const std::size_t first = bucket(hash) * ways;
+        std::uint8_t& hand = m_hands[bucket(hash)];
+        bool evicted = true;
+        std::size_t slot = first + hand;
+        for (std::size_t i = first; i < first + ways; ++i) {
+            if (!m_entries[i]) {
+                slot = i;
+                evicted = false;
+                break;
+            }
+        }
+        if (evicted) {
+            while (m_referenced[first + hand] != 0) {
+                m_referenced[first + hand] = 0;
+                hand = static_cast<std::uint8_t>((hand + 1) % ways);
+            }
+            slot = first + hand;
+            hand = static_cast<std::uint8_t>((hand + 1) % ways);
+        }
+        m_hashes[slot] = hash;
+        m_referenced[slot] = 0;
+        m_entries[slot].emplace(std::move(key), std::move(value));
+        return evicted;
+    }
+
+private:
+    std::size_t bucket(const std::uint64_t hash) const noexcept
+    { return static_cast<std::size_t>(hash >> 32) & m_bucket_mask; }
+
+    std::size_t m_bucket_mask = 0;
+    std::vector<std::uint64_t> m_hashes;
+    std::vector<std::uint8_t> m_referenced;
+    std::vector<std::optional<std::pair<Key, Value>>> m_entries;
+    std::vector<std::uint8_t> m_hands;
+};
+
+namespace stages {
+
+// The same as base_transform_stage, but results of F are cached by (all) input arguments
+template <class F>
+struct memoize_transform_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_incremental;
+
+    [[no_unique_address]]
+    F f;
+    std::size_t capacity;
+    memoize_counters* counters;
+
+    template <class Input>
+    struct impl
+    {
+        using input_type = Input;
+        using output_type = std::remove_cvref_t<args_invoke_result_t<F &, Input &&>>;
+        using stage_type = memoize_transform_stage;
+
+        using key_type = decltype(args_invoke([] <class... Args> (Args&&...) {
+            return std::tuple<memo_key_element_t<Args>...>{};
+        }, std::declval<Input>()));
+
+        [[no_unique_address]]
+        F f;
+        clock_cache<key_type, output_type> cache;
+        memoize_counters* counters;
+
+        template <class Next>
+        void process_incremental(Input&& input, Next&& next)
+        {
+            args_invoke([this, &next] <class... Args> (Args&&... args) {
+                std::uint64_t hash = 0;
+                ((hash = splitmix64::mix(hash + mixed_std_hash{}(memo_view(args)))), ...);
+
+                const auto key_equal = [&args...] (const key_type& key) {
+                    return std::apply([&args...] (const auto&... stored) {
+                        return ((memo_view(stored) == memo_view(args)) && ...);
+                    }, key);
+                };
+                if (const output_type* cached = cache.find(hash, key_equal)) {
+                    count(&memoize_counters::hits);
+                    next.process_incremental(output_type(*cached));
+                    return;
+                }
+
+                count(&memoize_counters::misses);
+                key_type key{memo_key_element_t<Args>(args)...};
+                output_type result = std::invoke(f, (Args&&) args...);
+                if (cache.insert(hash, std::move(key), output_type(result))) {
+                    count(&memoize_counters::evictions);
+                }
+                next.process_incremental(std::move(result));
+            }, (Input&&) input);
+        }
+
+        template <class Next>
+        void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
+
+        void count(std::uint64_t memoize_counters::* counter) noexcept
+        {
+            if (counters != nullptr) {
+                ++(counters->*counter);
+            }
+        }
+    };
+
+    template <class Input>
+    auto make_impl() const &
+    {
+        static_assert(is_args_invocable_v<F &, Input&&>,
+                "memoize_transform operation cannot be called with input type");
+        return impl<Input>{f, clock_cache<typename impl<Input>::key_type, typename impl<Input>::output_type>{capacity}, counters};
+    }
+
+    template <class Input>
+    auto make_impl() &&
+    {
+        static_assert(is_args_invocable_v<F &, Input&&>,
+                "memoize_transform operation cannot be called with input type");
+        return impl<Input>{(F&&) f, clock_cache<typename impl<Input>::key_type, typename impl<Input>::output_type>{capacity}, counters};
+    }
+};
+
+} // namespace stages
+} // namespace detail
+
+inline namespace stages {
+
+// transform(f) for expensive pure f: results are cached by input arguments (all arguments of args<> input)
+// in a bounded cache of at least 'capacity' entries with CLOCK eviction, see clock_cache.
+// Arguments should be hashable with std::hash and equality comparable; string-like arguments
+// (std::string_view, const char*, std::string) are stored as std::string, looked up without allocation.
+// The result is copied from the cache on a hit. Every chain created from the stage has its own cache.
+// Throws std::invalid_argument if capacity is 0.
+template <class F>
+auto memoize_transform(F&& f, const std::size_t capacity)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("memoize_transform: capacity should be positive");
+    }
+    return detail::stages::memoize_transform_stage<std::remove_cvref_t<F>>{(F&&) f, capacity, nullptr};
+}
+
+// Same, hits, misses and evictions are added to caller-owned 'counters' for tuning the capacity
+template <class F>
+auto memoize_transform(F&& f, const std::size_t capacity, const std::reference_wrapper<memoize_counters> counters)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("memoize_transform: capacity should be positive");
+    }
+    return detail::stages::memoize_transform_stage<std::remove_cvref_t<F>>{(F&&) f, capacity, &counters.get()};
+}
+
+} // namespace stages
+} // namespace descend
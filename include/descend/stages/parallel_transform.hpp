@@ -0,0 +1,369 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/helpers.hpp"
+#include "descend/stage_styles.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail {
+
+// Result of f computed by a worker: value or exception
+template <class Out>
+struct parallel_result
+{
+    std::optional<Out> value;
+    std::exception_ptr error;
+};
+
+// Elements of a chain waiting for a worker, see parallel_pool
+class parallel_task_source
+{
+public:
+    virtual ~parallel_task_source() = default;
+
+    // Computes one queued element, if any
+    virtual void run_one() = 0;
+};
+
+// Worker threads shared by all chains created from one parallel_transform stage (e.g. groups of map_group_by),
+// so the number of threads doesn't grow with the number of chains.
+// Every dispatched element adds its chain's source to the queue, a worker computes one element of it.
+// Sources are referenced weakly: elements of destroyed chains are skipped.
+class parallel_pool
+{
+public:
+    explicit parallel_pool(const std::size_t workers)
+        : m_workers(workers)
+    {}
+
+    parallel_pool(const parallel_pool&) = delete;
+    parallel_pool& operator = (const parallel_pool&) = delete;
+
+    ~parallel_pool()
+    {
+        {
+            const std::lock_guard lock{m_mutex};
+            m_stopping = true;
+        }
+        m_work_ready.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    // Threads are started with the first element
+    void submit(std::weak_ptr<parallel_task_source> source)
+    {
+        {
+            const std::lock_guard lock{m_mutex};
+            if (m_threads.empty()) {
+                m_threads.reserve(m_workers);
+                for (std::size_t i = 0; i < m_workers; ++i) {
+                    m_threads.emplace_back([this] { work(); });
+                }
+            }
+            m_queue.push_back(std::move(source));
+        }
+        m_work_ready.notify_one();
+    }
+
+private:
+    void work()
+    {
+        while (true) {
+            std::shared_ptr<parallel_task_source> source;
+            {
+                std::unique_lock lock{m_mutex};
+                m_work_ready.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_stopping) {
+                    return;
+                }
+                source = m_queue.front().lock();
+                m_queue.pop_front();
+            }
+            if (source) {
+                source->run_one();
+            }
+        }
+    }
+
+    const std::size_t m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_ready;
+    std::deque<std::weak_ptr<parallel_task_source>> m_queue;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+// Elements and results of f(input) of a single chain, computed by parallel_pool workers.
+// Elements are numbered in order of dispatch; with Ordered results are stored in a ring of 'window' slots
+// by the number (at most 'window' elements are in flight, so the slots don't collide), otherwise in order of completion.
+template <class In, class Out, class F, bool Ordered>
+class parallel_channel final : public parallel_task_source
+{
+public:
+    parallel_channel(F f, const std::size_t window)
+        : m_f(std::move(f))
+        , m_slots(Ordered ? window : 0)
+    {}
+
+    // The element is computed by one of the workers of the pool
+    static void dispatch(const std::shared_ptr<parallel_channel>& channel, parallel_pool& pool,
+                         const std::uint64_t number, In&& input)
+    {
+        {
+            const std::lock_guard lock{channel->m_mutex};
+            channel->m_queue.emplace_back(number, std::move(input));
+        }
+        pool.submit(channel);
+    }
+
+    // Takes a completed result (the one with 'number' if Ordered), waits for it only if 'wait' is true
+    std::optional<parallel_result<Out>> take(const std::uint64_t number, const bool wait)
+    {
+        std::unique_lock lock{m_mutex};
+        const auto ready = [this, number] {
+            if constexpr (Ordered) {
+                return m_slots[number % m_slots.size()].has_value();
+            }
+            else {
+                return !m_completed.empty();
+            }
+        };
+        if (wait) {
+            m_result_ready.wait(lock, ready);
+        }
+        else if (!ready()) {
+            return std::nullopt;
+        }
+
+        std::optional<parallel_result<Out>> result;
+        if constexpr (Ordered) {
+            result.swap(m_slots[number % m_slots.size()]);
+        }
+        else {
+            result.emplace(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    // Elements which are not started yet are dropped
+    void cancel()
+    {
+        const std::lock_guard lock{m_mutex};
+        m_queue.clear();
+    }
+
+    void run_one() override
+    {
+        std::optional<std::pair<std::uint64_t, In>> task;
+        {
+            const std::lock_guard lock{m_mutex};
+            if (m_queue.empty()) {
+                return; // cancelled
+            }
+            task.emplace(std::move(m_queue.front()));
+            m_queue.pop_front();
+        }
+
+        parallel_result<Out> result;
+        try {
+            result.value.emplace(std::invoke(m_f, std::move(task->second)));
+        }
+        catch (...) {
+            result.error = std::current_exception();
+        }
+
+        {
+            const std::lock_guard lock{m_mutex};
+            if constexpr (Ordered) {
+                m_slots[task->first % m_slots.size()].emplace(std::move(result));
+            }
+            else {
+                m_completed.push_back(std::move(result));
+            }
+        }
+        m_result_ready.notify_one();
+    }
+
+private:
+    const F m_f;
+
+    std::mutex m_mutex;
+    std::condition_variable m_result_ready;
+    std::deque<std::pair<std::uint64_t, In>> m_queue;
+    std::vector<std::optional<parallel_result<Out>>> m_slots;
+    std::deque<parallel_result<Out>> m_completed;
+};
+
+namespace stages {
+
+// Computes F on worker threads of the pool shared by all chains created from the stage,
+// with at most 'window' elements of a chain in flight. The next stages are called on the thread running the chain
+template <class F, bool Ordered>
+struct parallel_transform_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_incremental;
+
+    [[no_unique_address]]
+    F f;
+    std::shared_ptr<parallel_pool> pool;
+    std::size_t window;
+
+    template <class Input>
+    struct impl
+    {
+        static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>>,
+                "parallel_transform accepts single argument, use make_tuple() stage for multiple arguments");
+
+        using value_type = std::remove_cvref_t<Input>;
+
+        static_assert(std::is_invocable_v<const F&, value_type&&>,
+                "parallel_transform operation cannot be called with input type");
+
+        using input_type = Input;
+        using output_type = std::remove_cvref_t<std::invoke_result_t<const F&, value_type&&>>;
+        using stage_type = parallel_transform_stage;
+
+        using channel_type = parallel_channel<value_type, output_type, F, Ordered>;
+
+        std::shared_ptr<parallel_pool> pool;
+        std::shared_ptr<channel_type> channel;
+        std::size_t window;
+        std::uint64_t dispatched = 0;
+        std::uint64_t emitted = 0;
+
+        template <class Next>
+        void process_incremental(Input&& input, Next&& next)
+        {
+            emit(next, window - 1);
+            if (!next.done()) {
+                channel_type::dispatch(channel, *pool, dispatched++, value_type((Input&&) input));
+            }
+        }
+
+        template <class Next>
+        void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
+
+        template <class Next>
+        decltype(auto) end(Next&& next)
+        {
+            emit(next, 0);
+            return next.end();
+        }
+
+        // Passes completed results further while they are ready, waits for them while more than 'max_in_flight'
+        // elements are dispatched. When the next stages are done, stops dispatching and drops remaining results
+        template <class Next>
+        void emit(Next& next, const std::size_t max_in_flight)
+        {
+            while (emitted != dispatched && !next.done()) {
+                auto result = channel->take(emitted, dispatched - emitted > max_in_flight);
+                if (!result) {
+                    return;
+                }
+                ++emitted;
+                if (result->error) {
+                    std::rethrow_exception(result->error);
+                }
+                next.process_incremental(std::move(*result->value));
+            }
+            if (next.done()) {
+                channel->cancel();
+            }
+        }
+    };
+
+    template <class Input>
+    auto make_impl() const &
+    {
+        using impl_type = impl<Input>;
+        return impl_type{pool, std::make_shared<typename impl_type::channel_type>(f, window), window};
+    }
+
+    template <class Input>
+    auto make_impl() &&
+    {
+        using impl_type = impl<Input>;
+        return impl_type{std::move(pool), std::make_shared<typename impl_type::channel_type>((F&&) f, window), window};
+    }
+};
+
+template <bool Ordered, class F>
+auto make_parallel_transform_stage(F&& f, const std::size_t workers, const std::size_t window)
+{
+    if (workers == 0) {
+        throw std::invalid_argument("parallel_transform: number of workers should be positive");
+    }
+    if (window == 0) {
+        throw std::invalid_argument("parallel_transform: window should be positive");
+    }
+    return parallel_transform_stage<std::remove_cvref_t<F>, Ordered>{(F&&) f, std::make_shared<parallel_pool>(workers), window};
+}
+
+} // namespace stages
+} // namespace detail
+
+inline namespace stages {
+
+// transform(f) for expensive f (parsing, compression, crypto) computed by 'workers' threads,
+// results are passed to the next stages in the original order on the thread running the chain.
+// At most 'window' elements are in flight (dispatched and not passed further yet): when the oldest one is slow,
+// the chain waits for it. Inputs are copied (or moved) to the workers, f should be safe to call concurrently.
+// All chains created from the stage (e.g. groups of map_group_by) share its 'workers' threads, which are started
+// with the first element and joined when the stage and all its chains are destroyed.
+// When the next stages are done (e.g. take_n()), no new elements are dispatched and computed results are dropped.
+// Exceptions from f are rethrown on the chain thread. Include descend/stages/parallel_transform.hpp
+// separately and link with Threads::Threads.
+// Throws std::invalid_argument if workers or window is 0.
+//
+//      dd::apply(blobs, dd::parallel_transform(parse_json, 8), dd::filter(...), dd::to<std::vector>());
+template <class F>
+auto parallel_transform(F&& f, const std::size_t workers, const std::size_t window)
+{
+    return detail::stages::make_parallel_transform_stage<true>((F&&) f, workers, window);
+}
+
+// Same with window of 4 elements per worker
+template <class F>
+auto parallel_transform(F&& f, const std::size_t workers)
+{
+    return detail::stages::make_parallel_transform_stage<true>((F&&) f, workers, 4 * workers);
+}
+
+// parallel_transform() which passes results further in order of completion, so a slow element
+// doesn't hold back the others
+template <class F>
+auto parallel_transform_unordered(F&& f, const std::size_t workers, const std::size_t window)
+{
+    return detail::stages::make_parallel_transform_stage<false>((F&&) f, workers, window);
+}
+
+template <class F>
+auto parallel_transform_unordered(F&& f, const std::size_t workers)
+{
+    return detail::stages::make_parallel_transform_stage<false>((F&&) f, workers, 4 * workers);
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "descend/error_or.hpp"
+#include "descend/iterate.hpp"
+#include "descend/parse_number.hpp"
+#include "descend/stage_styles.hpp"
+#include "descend/stages/transform.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <ranges>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail::stages {
+
+template <class Input>
+consteval void check_parse_input()
+{
+    static_assert(std::is_convertible_v<Input, std::string_view>,
+            "parse stages accept single argument convertible to std::string_view");
+}
+
+template <class T>
+struct parse_number_op
+{
+    template <class Input>
+    error_or<T> operator () (Input&& input) const noexcept
+    {
+        check_parse_input<Input&&>();
+        return parse_number<T>(std::string_view((Input&&) input));
+    }
+};
+
+// These will only be used for displaying in case of debug output
+template <class T>
+struct parse_stage {};
+
+template <class T>
+struct parse_batch_stage
+{
+    static constexpr auto style = stage_styles::complete_to_complete;
+
+    static constexpr std::size_t block_size = 64;
+
+    template <class Input>
+    struct impl
+    {
+        using range_type = std::remove_reference_t<unwrapped_input_t<Input>>;
+
+        static_assert(std::ranges::sized_range<range_type>,
+                "parse_batch() requires complete sized input range (vector, array, span, ...)");
+
+        using input_type = Input;
+        using output_type = error_or<std::vector<T>>;
+        using stage_type = parse_batch_stage;
+
+        template <class Next>
+        decltype(auto) process_complete(Input&& input, Next&& next)
+        {
+            auto&& range = unwrap_input((Input&&) input);
+            std::vector<T> values(static_cast<std::size_t>(std::ranges::size(range)));
+
+            // errors are checked once per block, so there are no early exits in the parsing loop
+            std::errc errors[block_size];
+            auto it = std::ranges::begin(range);
+            for (std::size_t block = 0; block < values.size(); block += block_size) {
+                const std::size_t count = std::min(block_size, values.size() - block);
+                bool failed = false;
+                for (std::size_t i = 0; i < count; ++i, ++it) {
+                    errors[i] = parse_number_to(std::string_view(*it), values[block + i]);
+                    failed |= errors[i] != std::errc{};
+                }
+                if (failed) [[unlikely]] {
+                    const std::errc ec = *std::find_if(errors, errors + count, [] (const std::errc e) { return e != std::errc{}; });
+                    return next.process_complete(output_type{in_place_error, std::make_error_code(ec)});
+                }
+            }
+            return next.process_complete(output_type{in_place_value, std::move(values)});
+        }
+    };
+
+    template <class Input>
+    constexpr auto make_impl()
+    {
+        check_parse_input<std::ranges::range_reference_t<const std::remove_reference_t<unwrapped_input_t<Input>>&>>();
+        return impl<Input>{};
+    }
+};
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Parses input convertible to std::string_view as number of type T, outputs error_or<T>
+// (see parse_number<T>), which is handled with unwrap_error_or():
+//
+//      dd::apply(fields, dd::parse<int>(), dd::unwrap_error_or(), dd::to<std::vector>())
+//
+// Fixed-width integer fields of 8 or 16 digits are parsed with SWAR fast path, other input with std::from_chars.
+template <class T>
+constexpr auto parse()
+{
+    return detail::stages::make_base_transform_stage<detail::stages::parse_stage<T>>(detail::stages::parse_number_op<T>{});
+}
+
+// Parses complete input range of tokens (e.g. std::vector<std::string_view> of fields) at once into
+// error_or<std::vector<T>>, the error is the first one of parse<T>(), handled with unwrap_error_or_complete():
+//
+//      dd::apply(fields, dd::parse_batch<int>(), dd::unwrap_error_or_complete(), dd::transform_complete(...))
+//
+// Unlike parse<T>() + unwrap_error_or(), there is no error_or<T> per token and no per token error branch.
+template <class T>
+constexpr auto parse_batch()
+{
+    return detail::stages::parse_batch_stage<T>{};
+}
+
+} // namespace stages
+} // namespace descend
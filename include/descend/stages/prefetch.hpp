@@ -0,0 +1,146 @@
+#pragma once
+
+#include "descend/helpers.hpp"
+#include "descend/iterate.hpp"
+#include "descend/stage_styles.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+namespace detail::stages {
+
+// Hint to the CPU to load the cache line with 'address' for reading, no-op if not supported
+constexpr void prefetch_address([[maybe_unused]] const void* address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    if (!std::is_constant_evaluated()) {
+        __builtin_prefetch(address, 0, 3);
+    }
+#endif
+}
+
+// Source produced by prefetch() stage: iterates random access range by index and before passing
+// element i to the next stages prefetches address_fn(range[i + distance]).
+// Range is a reference type (const X&, X&, X&&), the range is owned by the previous stage, which outlives the iteration.
+template <class Range, class AddressFn>
+struct prefetching_source
+{
+    using custom_source_tag = void;
+
+    using element_type = decltype(forward_like<Range>(*std::ranges::begin(std::declval<Range&>())));
+
+    template <class Self>
+    using output_type = element_type;
+
+    std::remove_reference_t<Range>* range;
+    std::size_t distance;
+    const AddressFn* address_fn;
+
+    constexpr std::size_t size() const
+    {
+        return static_cast<std::size_t>(std::ranges::size(*range));
+    }
+
+    template <class Self, class Done, class Callback>
+    static constexpr void iterate(Self&& self, Done&& done, Callback&& callback)
+    {
+        using difference_type = std::ranges::range_difference_t<std::remove_reference_t<Range>>;
+        const auto first = std::ranges::begin(*self.range);
+        const std::size_t n = self.size();
+
+        const auto prefetch_element = [&self, &first] (const std::size_t i) {
+            prefetch_address(std::invoke(*self.address_fn, std::as_const(first[static_cast<difference_type>(i)])));
+        };
+
+        // warm up: first 'distance' elements are requested before the processing starts
+        const std::size_t warm_up = self.distance < n ? self.distance : n;
+        for (std::size_t i = 0; i < warm_up; ++i) {
+            prefetch_element(i);
+        }
+
+        for (std::size_t i = 0; i < n && !done(); ++i) {
+            if (i + self.distance < n) {
+                prefetch_element(i + self.distance);
+            }
+            callback(forward_like<Range>(first[static_cast<difference_type>(i)]));
+        }
+    }
+};
+
+template <class AddressFn>
+struct prefetch_stage
+{
+    static constexpr auto style = stage_styles::complete_to_complete;
+
+    std::size_t distance;
+
+    [[no_unique_address]]
+    AddressFn address_fn;
+
+    template <class Input>
+    struct impl
+    {
+        using range_type = unwrapped_input_t<Input>;
+
+        static_assert(   std::ranges::random_access_range<std::remove_reference_t<range_type>>
+                      && std::ranges::sized_range<std::remove_reference_t<range_type>>,
+                "prefetch() requires complete random access input (vector, array, span, ...)");
+        static_assert(std::is_convertible_v<
+                    std::invoke_result_t<const AddressFn&, std::ranges::range_reference_t<const std::remove_reference_t<range_type>&>>,
+                    const void*>,
+                "prefetch() address function should return a pointer");
+
+        using input_type = Input;
+        using output_type = prefetching_source<range_type, AddressFn>;
+        using stage_type = prefetch_stage;
+
+        std::size_t distance;
+
+        [[no_unique_address]]
+        AddressFn address_fn;
+
+        template <class Next>
+        constexpr decltype(auto) process_complete(Input&& input, Next&& next)
+        {
+            auto&& range = unwrap_input((Input&&) input);
+            return next.process_complete(output_type{std::addressof(range), distance, std::addressof(address_fn)});
+        }
+    };
+
+    template <class Input>
+    constexpr auto make_impl() &
+    {
+        return impl<Input>{distance, address_fn};
+    }
+    template <class Input>
+    constexpr auto make_impl() &&
+    {
+        return impl<Input>{distance, (AddressFn&&) address_fn};
+    }
+};
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Issues software prefetch for the element 'distance' positions ahead before the current one is processed.
+// Input should be complete random access range, address_fn(const element&) returns the address to prefetch,
+// by default the element itself (e.g. for std::vector<Record*>):
+//
+//      dd::apply(records, dd::prefetch(16), dd::transform([] (const Record* r) { return r->value; }), ...);
+//      dd::apply(indices, dd::prefetch(16, [&] (std::uint32_t i) { return &table[i]; }), ...);
+//
+// Should be followed by incremental stages.
+template <class AddressFn = std::identity>
+constexpr auto prefetch(const std::size_t distance, AddressFn&& address_fn = {})
+{
+    return detail::stages::prefetch_stage<std::remove_cvref_t<AddressFn>>{distance, (AddressFn&&) address_fn};
+}
+
+} // namespace stages
+} // namespace descend
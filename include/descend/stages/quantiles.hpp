@@ -0,0 +1,72 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/finalize.hpp"
+#include "descend/helpers.hpp"
+#include "descend/kll_sketch.hpp"
+#include "descend/stages/accumulate.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail::stages {
+
+// Sketch parameter k for the requested normalized rank error, KLL error is about 1.7 / k
+inline std::size_t kll_k_for_accuracy(const double accuracy)
+{
+    if (!(accuracy > 0.0 && accuracy < 1.0)) {
+        throw std::invalid_argument("quantiles: accuracy should be in (0, 1)");
+    }
+    return std::max<std::size_t>(8, static_cast<std::size_t>(std::ceil(2.0 / accuracy)));
+}
+
+template <class Display, class Finish>
+auto make_kll_stage(const double accuracy, Finish&& finish)
+{
+    auto make_init = [k = kll_k_for_accuracy(accuracy)] <class Input> ()
+    {
+        static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>>,
+                "quantile stages accept single argument, use make_pair()/make_tuple() stages for multiple arguments");
+        return kll_sketch<finalize_result_t<Input, false>>{k};
+    };
+    auto update_op = [] <class T, class Input> (kll_sketch<T>& sketch, Input&& input)
+    {
+        sketch.add(input);
+    };
+
+    return make_base_accumulate_stage<Display>(std::move(make_init), std::move(update_op), (Finish&&) finish);
+}
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Outputs std::vector<T> with approximate quantiles of the input, one per rank in qs (each in [0, 1]),
+// T is decayed Input. Empty input gives empty vector.
+// Rank of every returned element is within about 'accuracy' of the requested one with high probability,
+// memory is O(1 / accuracy) elements regardless of the input size (see kll_sketch).
+// Can be used per group, e.g. map_group_by<std::unordered_map>(key_getter, quantiles({0.5, 0.99})).
+// Throws std::invalid_argument for q outside of [0, 1] or accuracy outside of (0, 1).
+inline auto quantiles(const std::initializer_list<double> qs, const double accuracy = 0.01)
+{
+    kll_sketch<double>::check_ranks(qs);
+    return detail::stages::make_kll_stage<struct quantiles_stage>(
+            accuracy,
+            [qs = std::vector<double>(qs)] <class T> (kll_sketch<T>&& sketch) { return sketch.quantiles(qs); });
+}
+
+// Outputs kll_sketch itself, sketches from different runs (e.g. shards) can be merged and queried later
+inline auto quantile_sketch(const double accuracy = 0.01)
+{
+    return detail::stages::make_kll_stage<struct quantile_sketch_stage>(
+            accuracy, [] <class T> (kll_sketch<T>&& sketch) { return std::move(sketch); });
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/finalize.hpp"
+#include "descend/helpers.hpp"
+#include "descend/higher_order.hpp"
+#include "descend/stages/accumulate.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail::stages {
+
+// Reservoir sampling with Algorithm L (Li, 1994): after the reservoir is filled, the number of elements
+// to skip before the next replacement is drawn from geometric distribution, so RNG is called
+// O(k * (1 + log(n / k))) times instead of once per element.
+template <class T>
+struct reservoir
+{
+    std::vector<T> items;
+    std::size_t k;
+    splitmix64 rng;
+    double w = 0.0;          // max of k uniform keys among the current sample
+    std::uint64_t seen = 0;  // number of elements processed so far
+    std::uint64_t next = 0;  // index of the next element to put into reservoir (once it is full)
+
+    reservoir(const std::size_t k_, const std::uint64_t seed)
+        : k(k_), rng{seed}
+    {
+        items.reserve(k);
+    }
+
+    // uniform in (0, 1)
+    double uniform() noexcept
+    {
+        return (static_cast<double>(rng() >> 11) + 0.5) * 0x1.0p-53;
+    }
+
+    void update_weight() noexcept
+    {
+        w *= std::exp(std::log(uniform()) / static_cast<double>(k));
+    }
+
+    void advance_next() noexcept
+    {
+        constexpr auto max_skip = static_cast<double>(std::numeric_limits<std::uint64_t>::max() / 2);
+        const double skip = std::floor(std::log(uniform()) / std::log1p(-w));
+        // very small w gives huge skip: no more replacements are expected
+        next = skip < max_skip ? next + static_cast<std::uint64_t>(skip) + 1 : std::numeric_limits<std::uint64_t>::max();
+    }
+
+    template <class Input>
+    void fill(Input&& input)
+    {
+        items.emplace_back((Input&&) input);
+        if (++seen == k) {
+            w = 1.0;
+            update_weight();
+            next = k - 1;
+            advance_next();
+        }
+    }
+
+    template <class Input>
+    void replace(Input&& input)
+    {
+        // modulo bias is at most k / 2^64
+        items[static_cast<std::size_t>(rng() % k)] = T((Input&&) input);
+        update_weight();
+        advance_next();
+    }
+};
+
+struct sample_update
+{
+    template <class T, class Input>
+    void operator () (reservoir<T>& r, Input&& input) const
+    {
+        if (r.seen < r.k) {
+            r.fill((Input&&) input);
+            return;
+        }
+        if (r.k != 0 && r.seen == r.next) {
+            r.replace((Input&&) input);
+        }
+        ++r.seen;
+    }
+
+    // Jumps directly to the elements getting into the reservoir, skipped elements are not touched.
+    // Consumes the same random numbers as element by element processing, so the result is the same.
+    template <class T, class Element>
+    void update_random_access(reservoir<T>& r, const std::size_t size, Element&& element) const
+    {
+        const std::uint64_t base = r.seen;
+        const std::uint64_t end = base + size;
+
+        while (r.seen < r.k && r.seen < end) {
+            r.fill(element(static_cast<std::size_t>(r.seen - base)));
+        }
+        if (r.seen < r.k || r.k == 0) {
+            r.seen = end;
+            return;
+        }
+        while (r.next < end) {
+            r.replace(element(static_cast<std::size_t>(r.next - base)));
+        }
+        r.seen = end;
+    }
+};
+
+struct sample_finish
+{
+    template <class T>
+    std::vector<T> operator () (reservoir<T>&& r) const
+    {
+        return std::move(r.items);
+    }
+};
+
+template <class Input>
+using sample_value_t = finalize_result_t<Input, false>;
+
+template <class Input>
+consteval void check_sample_input()
+{
+    static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>>,
+            "sample stages accept single argument, use make_pair()/make_tuple() stages for multiple arguments");
+}
+
+// Seed of i-th reservoir created by sample_by_key(), so samples of different groups are independent
+constexpr std::uint64_t group_seed(const std::uint64_t seed, const std::uint64_t group) noexcept
+{
+    return splitmix64{seed ^ (group * 0xd1b54a32d192ed03ULL)}();
+}
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Outputs std::vector<T> with uniform random sample of (at most) k elements, T is decayed Input.
+// The same seed and input give the same sample. Elements are in no particular order.
+// Complete random access input (e.g. std::vector) is processed jumping over skipped elements.
+constexpr auto sample(const std::size_t k, const std::uint64_t seed)
+{
+    auto make_init = [k, seed] <class Input> ()
+    {
+        detail::stages::check_sample_input<Input>();
+        return detail::stages::reservoir<detail::stages::sample_value_t<Input>>{k, seed};
+    };
+
+    return detail::stages::make_base_accumulate_stage<struct sample_stage>(
+            std::move(make_init), detail::stages::sample_update{}, detail::stages::sample_finish{});
+}
+
+// Samples (at most) k elements for every key, outputs args<Key, std::vector<T>> like map_group_by<Map>() does.
+// Every group gets its own seed derived from 'seed' and the order in which groups appear,
+// so samples of different groups are independent and the whole result is reproducible.
+template <template <class...> class Map, class KeyGetter>
+constexpr auto sample_by_key(KeyGetter&& key_getter, const std::size_t k, const std::uint64_t seed)
+{
+    auto make_init = [k, seed, group = std::uint64_t{0}] <class Input> () mutable
+    {
+        detail::stages::check_sample_input<Input>();
+        return detail::stages::reservoir<detail::stages::sample_value_t<Input>>{
+                k, detail::stages::group_seed(seed, group++)};
+    };
+
+    return map_group_by<Map>(
+            (KeyGetter&&) key_getter,
+            detail::stages::make_base_accumulate_stage<struct sample_by_key_stage>(
+                    std::move(make_init), detail::stages::sample_update{}, detail::stages::sample_finish{}));
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "descend/running_stats.hpp"
+#include "descend/stages/accumulate.hpp"
+#include "descend/stages/prefetch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace descend {
+namespace detail::stages {
+
+template <class Input>
+consteval void check_stats_input()
+{
+    static_assert(std::is_arithmetic_v<std::remove_cvref_t<Input>>,
+            "stats() and sum_precise() accept single arithmetic argument");
+}
+
+// Values are processed in 'lanes' independent accumulators, so there are no dependencies between
+// consecutive additions and the compiler vectorizes the loop without reassociating floating point operations
+inline constexpr std::size_t stats_lanes = 8;
+
+// Contiguous input is prefetched this many values ahead of the SIMD lanes,
+// the hardware prefetcher alone leaves the compensated sum waiting for memory
+inline constexpr std::size_t stats_prefetch_distance = 256;
+
+// Neumaier (improved Kahan-Babuska) compensated summation: error doesn't grow with the number of values.
+// Note: -ffast-math allows the compiler to remove the compensation
+struct compensated_sum
+{
+    double sums[stats_lanes] = {};
+    double compensations[stats_lanes] = {};
+
+    static constexpr void add_to(double& sum, double& compensation, const double x) noexcept
+    {
+        const double t = sum + x;
+        const bool sum_is_larger = std::abs(sum) >= std::abs(x);
+        const double larger = sum_is_larger ? sum : x;
+        const double smaller = sum_is_larger ? x : sum;
+        compensation += (larger - t) + smaller;
+        sum = t;
+    }
+
+    double result() const noexcept
+    {
+        double sum = 0.0;
+        double compensation = 0.0;
+        for (std::size_t j = 0; j < stats_lanes; ++j) {
+            add_to(sum, compensation, sums[j]);
+        }
+        for (std::size_t j = 0; j < stats_lanes; ++j) {
+            add_to(sum, compensation, compensations[j]);
+        }
+        return sum + compensation;
+    }
+};
+
+struct sum_precise_update
+{
+    template <class Input>
+    void operator () (compensated_sum& accum, Input&& input) const noexcept
+    {
+        check_stats_input<Input>();
+        compensated_sum::add_to(accum.sums[0], accum.compensations[0], static_cast<double>(input));
+    }
+
+    template <class Element>
+    void update_random_access(compensated_sum& accum, const std::size_t size, Element&& element) const noexcept
+    {
+        check_stats_input<decltype(element(0))>();
+        for (std::size_t i = 0; i < size; ++i) {
+            compensated_sum::add_to(accum.sums[0], accum.compensations[0], static_cast<double>(element(i)));
+        }
+    }
+
+    // Contiguous doubles (vector, array, span) are summed in independent lanes
+    void update_contiguous(compensated_sum& accum, const double* data, const std::size_t size) const noexcept
+    {
+        for (std::size_t i = add_lanes(accum, data, size); i < size; ++i) {
+            compensated_sum::add_to(accum.sums[0], accum.compensations[0], data[i]);
+        }
+    }
+
+    // The compiler doesn't vectorize the loop itself (add_to() compares the running sum, so it is not a reduction),
+    // so SSE2/AVX lanes are updated explicitly in a single pass.
+    // Lanes use branchless TwoSum instead of comparing magnitudes: the error of each addition is exact in both,
+    // so the result is the same with fewer instructions per vector.
+    // Returns the number of processed values
+    static std::size_t add_lanes(compensated_sum& accum, const double* data, const std::size_t size) noexcept
+    {
+        const std::size_t lanes_end = size - size % stats_lanes;
+#if defined(__AVX__)
+        using vec = __m256d;
+        constexpr std::size_t width = 4;
+        const auto load = [] (const double* p) { return _mm256_loadu_pd(p); };
+        const auto store = [] (double* p, const vec v) { _mm256_storeu_pd(p, v); };
+        const auto two_sum = [] (vec& sum, vec& compensation, const vec x) {
+            const vec t = _mm256_add_pd(sum, x);
+            const vec x_part = _mm256_sub_pd(t, sum);
+            const vec error = _mm256_add_pd(_mm256_sub_pd(sum, _mm256_sub_pd(t, x_part)), _mm256_sub_pd(x, x_part));
+            compensation = _mm256_add_pd(compensation, error);
+            sum = t;
+        };
+#elif defined(__SSE2__)
+        using vec = __m128d;
+        constexpr std::size_t width = 2;
+        const auto load = [] (const double* p) { return _mm_loadu_pd(p); };
+        const auto store = [] (double* p, const vec v) { _mm_storeu_pd(p, v); };
+        const auto two_sum = [] (vec& sum, vec& compensation, const vec x) {
+            const vec t = _mm_add_pd(sum, x);
+            const vec x_part = _mm_sub_pd(t, sum);
+            const vec error = _mm_add_pd(_mm_sub_pd(sum, _mm_sub_pd(t, x_part)), _mm_sub_pd(x, x_part));
+            compensation = _mm_add_pd(compensation, error);
+            sum = t;
+        };
+#endif
+#if defined(__AVX__) || defined(__SSE2__)
+        constexpr std::size_t vectors = stats_lanes / width;
+        vec sums[vectors];
+        vec compensations[vectors];
+        for (std::size_t v = 0; v < vectors; ++v) {
+            sums[v] = load(accum.sums + v * width);
+            compensations[v] = load(accum.compensations + v * width);
+        }
+        for (std::size_t i = 0; i < lanes_end; i += stats_lanes) {
+            prefetch_address(data + std::min(i + stats_prefetch_distance, size));
+            for (std::size_t v = 0; v < vectors; ++v) {
+                two_sum(sums[v], compensations[v], load(data + i + v * width));
+            }
+        }
+        for (std::size_t v = 0; v < vectors; ++v) {
+            store(accum.sums + v * width, sums[v]);
+            store(accum.compensations + v * width, compensations[v]);
+        }
+#else
+        for (std::size_t i = 0; i < lanes_end; i += stats_lanes) {
+            for (std::size_t j = 0; j < stats_lanes; ++j) {
+                compensated_sum::add_to(accum.sums[j], accum.compensations[j], data[i + j]);
+            }
+        }
+#endif
+        return lanes_end;
+    }
+};
+
+struct sum_precise_finish
+{
+    double operator () (compensated_sum&& accum) const noexcept
+    {
+        return accum.result();
+    }
+};
+
+struct stats_update
+{
+    template <int MaxMoment, class Input>
+    void operator () (running_stats<MaxMoment>& stats, Input&& input) const noexcept
+    {
+        check_stats_input<Input>();
+        stats.add(static_cast<double>(input));
+    }
+
+    // Two passes over chunks small enough to stay in L1 cache: mean of the chunk, then sums of powers
+    // of deviations from it. Chunk statistics are merged into the result.
+    template <int MaxMoment, class Element>
+    void update_random_access(running_stats<MaxMoment>& stats, const std::size_t size, Element&& element) const noexcept
+    {
+        check_stats_input<decltype(element(0))>();
+        constexpr std::size_t chunk = 512;
+
+        for (std::size_t first = 0; first < size; first += chunk) {
+            const std::size_t n = std::min(chunk, size - first);
+            const double dn = static_cast<double>(n);
+
+            double sums[stats_lanes] = {};
+            lanes_loop(first, n, element, [&sums] (const std::size_t j, const double x) { sums[j] += x; });
+            const double mean = total(sums) / dn;
+
+            double deviations[stats_lanes] = {};
+            double m2[stats_lanes] = {};
+            double m3[stats_lanes] = {};
+            double m4[stats_lanes] = {};
+            lanes_loop(first, n, element, [&] (const std::size_t j, const double x) {
+                const double d = x - mean;
+                const double d2 = d * d;
+                deviations[j] += d;
+                m2[j] += d2;
+                if constexpr (MaxMoment == 4) {
+                    m3[j] += d2 * d;
+                    m4[j] += d2 * d2;
+                }
+            });
+            // rounding error of the mean is corrected with the sum of deviations ("corrected two-pass algorithm")
+            const double correction = total(deviations);
+            stats.merge(running_stats<MaxMoment>{
+                    n, mean + correction / dn, total(m2) - correction * correction / dn, total(m3), total(m4)});
+        }
+    }
+
+    template <class Element, class Op>
+    static void lanes_loop(const std::size_t first, const std::size_t n, Element& element, Op&& op) noexcept
+    {
+        const std::size_t lanes_end = n - n % stats_lanes;
+        for (std::size_t i = 0; i < lanes_end; i += stats_lanes) {
+            for (std::size_t j = 0; j < stats_lanes; ++j) {
+                op(j, static_cast<double>(element(first + i + j)));
+            }
+        }
+        for (std::size_t i = lanes_end; i < n; ++i) {
+            op(0, static_cast<double>(element(first + i)));
+        }
+    }
+
+    static double total(const double (&lanes)[stats_lanes]) noexcept
+    {
+        double sum = 0.0;
+        for (const double x : lanes) {
+            sum += x;
+        }
+        return sum;
+    }
+};
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Outputs running_stats<MaxMoment> of arithmetic input: count, mean, variance
+// (and skewness, kurtosis for MaxMoment 4), numerically stable in a single pass.
+// Results of sharded or parallel runs can be combined with running_stats::merge().
+// Complete random access input (e.g. std::vector<double>) is processed in chunks with vectorized loops.
+template <int MaxMoment = 2>
+constexpr auto stats()
+{
+    auto make_init = [] <class Input> ()
+    {
+        return running_stats<MaxMoment>{};
+    };
+    return detail::stages::make_base_accumulate_stage<struct stats_stage>(
+            std::move(make_init), detail::stages::stats_update{});
+}
+
+// Outputs sum of arithmetic input as double using compensated (Neumaier) summation,
+// error doesn't depend on the number of values unlike accumulate(0.0).
+// Contiguous doubles are summed in several independent SIMD lanes, which keeps the compensation cheap.
+constexpr auto sum_precise()
+{
+    auto make_init = [] <class Input> ()
+    {
+        return detail::stages::compensated_sum{};
+    };
+    return detail::stages::make_base_accumulate_stage<struct sum_precise_stage>(
+            std::move(make_init), detail::stages::sum_precise_update{}, detail::stages::sum_precise_finish{});
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/error_or.hpp"
+#include "descend/finalize.hpp"
+#include "descend/helpers.hpp"
+#include "descend/inplace_vector.hpp"
+#include "descend/stage_styles.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace descend {
+
+// What fixed-capacity sinks (to_static<N>(), to_array<N>()) do when there are more than N elements
+namespace overflow {
+
+// Abort the program, or fail compilation when evaluated at compile time
+struct trap_t {};
+inline constexpr trap_t trap{};
+
+// Keep first N elements, stop the computation after that
+struct truncate_t {};
+inline constexpr truncate_t truncate{};
+
+// Stop the computation, return error_or<> with std::errc::value_too_large
+struct error_t {};
+inline constexpr error_t error{};
+
+} // namespace overflow
+
+namespace detail::stages {
+
+// Collects elements into container with fixed capacity N, which never allocates.
+// Storage is inplace_vector<T, N> for to_static<N>() and std::array<T, N> for to_array<N>(),
+// the latter is output as std::pair with the number of received elements, the rest stay value-initialized.
+template <std::size_t N, bool AsArray, class OverflowPolicy>
+struct to_static_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_complete;
+
+    template <class Input>
+    struct impl
+    {
+        static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>>,
+                "to_static/to_array stages accept single argument, use make_pair()/make_tuple() stages for multiple arguments");
+
+        using value_type = finalize_result_t<Input, false>; // keep reference wrappers as is
+        using container_type = std::conditional_t<AsArray, std::array<value_type, N>, inplace_vector<value_type, N>>;
+        using result_type = std::conditional_t<AsArray, std::pair<container_type, std::size_t>, container_type>;
+
+        static constexpr auto output_type_helper() noexcept
+        {
+            if constexpr (std::is_same_v<OverflowPolicy, overflow::error_t>) {
+                return std::type_identity<error_or<result_type>>{};
+            }
+            else {
+                return std::type_identity<result_type>{};
+            }
+        }
+
+        constexpr result_type make_result()
+        {
+            if constexpr (AsArray) {
+                return result_type{std::move(out), size};
+            }
+            else {
+                return std::move(out);
+            }
+        }
+
+        using input_type = Input;
+        using output_type = typename decltype(output_type_helper())::type;
+        using stage_type = to_static_stage;
+
+        container_type out = {};
+        std::size_t size = 0;
+        bool overflowed = false;
+
+        template <class Next>
+        constexpr void process_incremental(Input&& input, Next&&)
+        {
+            if (size == N) [[unlikely]] {
+                if constexpr (std::is_same_v<OverflowPolicy, overflow::trap_t>) {
+                    std::abort(); // not constexpr: compilation fails during constant evaluation
+                }
+                overflowed = true;
+                return;
+            }
+
+            if constexpr (AsArray) {
+                out[size] = value_type((Input&&) input);
+            }
+            else {
+                out.unchecked_emplace_back((Input&&) input);
+            }
+            ++size;
+        }
+
+        constexpr bool done() const
+        {
+            if constexpr (std::is_same_v<OverflowPolicy, overflow::truncate_t>) {
+                return size == N;
+            }
+            else {
+                return overflowed;
+            }
+        }
+
+        template <class Next>
+        constexpr decltype(auto) end(Next&& next)
+        {
+            if constexpr (std::is_same_v<OverflowPolicy, overflow::error_t>) {
+                return overflowed
+                    ? next.process_complete(output_type{in_place_error, std::make_error_code(std::errc::value_too_large)})
+                    : next.process_complete(output_type{in_place_value, make_result()});
+            }
+            else {
+                return next.process_complete(make_result());
+            }
+        }
+    };
+
+    template <class Input>
+    constexpr auto make_impl()
+    {
+        return impl<Input>{};
+    }
+};
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Collects up to N elements into inplace_vector<T, N>, never allocates.
+// Usable in constant evaluation: constexpr auto table = dd::apply(..., dd::to_static<16>());
+template <std::size_t N, class OverflowPolicy = overflow::trap_t>
+constexpr auto to_static(OverflowPolicy = {})
+{
+    return detail::stages::to_static_stage<N, false, OverflowPolicy>{};
+}
+
+// Collects up to N elements into std::array<T, N>, outputs std::pair of the array and the number of received
+// elements. Elements after that are value-initialized.
+//      constexpr auto [table, size] = dd::apply(..., dd::to_array<16>());
+template <std::size_t N, class OverflowPolicy = overflow::trap_t>
+constexpr auto to_array(OverflowPolicy = {})
+{
+    return detail::stages::to_static_stage<N, true, OverflowPolicy>{};
+}
+
+} // namespace stages
+} // namespace descend
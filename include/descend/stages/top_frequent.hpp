@@ -0,0 +1,176 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/count_min_sketch.hpp"
+#include "descend/finalize.hpp"
+#include "descend/helpers.hpp"
+#include "descend/stages/accumulate.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail::stages {
+
+// Heavy hitters: Count-Min sketch estimates frequencies, min-heap keeps k elements with the largest estimates.
+// An element replaces the heap minimum when its estimate gets larger, so memory is the sketch plus k candidates
+// regardless of the number of distinct elements.
+template <class T, class Hash>
+struct heavy_hitters
+{
+    struct candidate
+    {
+        T value;
+        std::uint64_t count;
+    };
+
+    // Hash adapter for positions map, reuses the sketch hash
+    struct map_hash
+    {
+        [[no_unique_address]]
+        Hash hash;
+
+        std::size_t operator () (const T& value) const
+        {
+            return static_cast<std::size_t>(std::invoke(hash, value));
+        }
+    };
+
+    std::size_t k;
+    count_min_sketch sketch;
+    [[no_unique_address]]
+    Hash hash;
+    std::vector<candidate> heap;
+    std::unordered_map<T, std::size_t, map_hash> positions; // value -> index in heap
+
+    heavy_hitters(const std::size_t k_, const std::size_t width, const std::size_t depth, Hash hash_)
+        : k(k_), sketch(width, depth), hash(hash_), positions(0, map_hash{std::move(hash_)})
+    {
+        heap.reserve(k);
+        positions.reserve(k);
+    }
+
+    void add(const T& value)
+    {
+        const std::uint64_t estimate = sketch.add_hash(static_cast<std::uint64_t>(std::invoke(hash, value)));
+        if (k == 0) {
+            return;
+        }
+        // candidates' counts are at least the heap minimum, so the rest of the elements are skipped
+        // without looking them up
+        if (heap.size() == k && estimate < heap.front().count) {
+            return;
+        }
+
+        if (const auto it = positions.find(value); it != positions.end()) {
+            heap[it->second].count = estimate;
+            sift_down(it->second);
+        }
+        else if (heap.size() < k) {
+            heap.push_back({value, estimate});
+            positions.emplace(value, heap.size() - 1);
+            sift_up(heap.size() - 1);
+        }
+        else if (estimate > heap.front().count) {
+            positions.erase(heap.front().value);
+            heap.front() = {value, estimate};
+            positions.emplace(value, 0);
+            sift_down(0);
+        }
+    }
+
+    void swap_candidates(const std::size_t i, const std::size_t j)
+    {
+        std::swap(heap[i], heap[j]);
+        positions[heap[i].value] = i;
+        positions[heap[j].value] = j;
+    }
+
+    void sift_up(std::size_t i)
+    {
+        while (i > 0) {
+            const std::size_t parent = (i - 1) / 2;
+            if (heap[parent].count <= heap[i].count) {
+                break;
+            }
+            swap_candidates(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down(std::size_t i)
+    {
+        while (true) {
+            const std::size_t left = 2 * i + 1;
+            const std::size_t right = left + 1;
+            std::size_t smallest = i;
+            if (left < heap.size() && heap[left].count < heap[smallest].count) {
+                smallest = left;
+            }
+            if (right < heap.size() && heap[right].count < heap[smallest].count) {
+                smallest = right;
+            }
+            if (smallest == i) {
+                break;
+            }
+            swap_candidates(i, smallest);
+            i = smallest;
+        }
+    }
+};
+
+struct top_frequent_finish
+{
+    template <class T, class Hash>
+    std::vector<std::pair<T, std::uint64_t>> operator () (heavy_hitters<T, Hash>&& hitters) const
+    {
+        std::vector<std::pair<T, std::uint64_t>> result;
+        result.reserve(hitters.heap.size());
+        for (auto& [value, count] : hitters.heap) {
+            result.emplace_back(std::move(value), count);
+        }
+        std::sort(result.begin(), result.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+        });
+        return result;
+    }
+};
+
+} // namespace detail::stages
+
+inline namespace stages {
+
+// Outputs (at most) k most frequent elements with their estimated counts as std::vector<std::pair<T, std::uint64_t>>,
+// sorted by count descending, T is decayed Input. Frequencies are estimated by count_min_sketch(width, depth),
+// counts may be overestimated by about 2 * n / width, so elements with close frequencies may be reordered.
+// Memory doesn't depend on the number of distinct elements.
+// Hash should return well mixed 64-bit value for const T&, T should be equality comparable.
+template <class Hash = detail::mixed_std_hash>
+auto top_frequent(const std::size_t k, const std::size_t width = 2048, const std::size_t depth = 4, Hash&& hash = {})
+{
+    count_min_sketch::validate(width, depth); // throws on invalid dimensions when the stage is created
+
+    auto make_init = [k, width, depth, hash = (Hash&&) hash] <class Input> ()
+    {
+        static_assert(!detail::is_specialization_of_v<detail::args, std::remove_cvref_t<Input>>,
+                "top_frequent accepts single argument, use make_pair()/make_tuple() stages for multiple arguments");
+        using value_type = detail::finalize_result_t<Input, false>;
+        return detail::stages::heavy_hitters<value_type, std::remove_cvref_t<Hash>>{k, width, depth, hash};
+    };
+    auto update_op = [] <class T, class H, class Input> (detail::stages::heavy_hitters<T, H>& hitters, Input&& input)
+    {
+        hitters.add(input);
+    };
+
+    return detail::stages::make_base_accumulate_stage<struct top_frequent_stage>(
+            std::move(make_init), std::move(update_op), detail::stages::top_frequent_finish{});
+}
+
+} // namespace stages
+} // namespace descend
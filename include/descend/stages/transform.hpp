@@ -3,6 +3,7 @@
 #include "descend/args.hpp"
 #include "descend/stage_styles.hpp"
 
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 
@@ -40,6 +41,12 @@ struct base_transform_stage
         {
             next.process_incremental(args_invoke(transform, (Input&&) input));
         }
+
+        template <class Next>
+        constexpr void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
     };
 
     template <class Input>
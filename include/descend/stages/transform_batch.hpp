@@ -0,0 +1,172 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/helpers.hpp"
+#include "descend/stage_styles.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace descend {
+namespace detail {
+
+// Element type of the output span of a batch function with non-template call operator:
+// f(std::span<const In>, std::span<Out>) -> Out, void if it can't be deduced
+template <class F>
+struct batch_output
+{
+    using type = void;
+};
+
+template <class R, class In, class Out>
+struct batch_output<R (*)(std::span<In>, std::span<Out>)>
+{
+    using type = Out;
+};
+
+template <class R, class C, class In, class Out>
+struct batch_output<R (C::*)(std::span<In>, std::span<Out>) const>
+{
+    using type = Out;
+};
+
+template <class R, class C, class In, class Out>
+struct batch_output<R (C::*)(std::span<In>, std::span<Out>)>
+{
+    using type = Out;
+};
+
+template <class F>
+    requires requires { &F::operator(); }
+struct batch_output<F> : batch_output<decltype(&F::operator())>
+{};
+
+template <class F>
+using batch_output_t = typename batch_output<std::decay_t<F>>::type;
+
+namespace stages {
+
+// Buffers up to batch_size inputs, calls f(std::span<const In>, std::span<Out>) when the buffer is full
+// and at the end, then passes outputs further one by one while the next stages are not done
+template <class Out, class F>
+struct transform_batch_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_incremental;
+
+    std::size_t batch_size;
+
+    [[no_unique_address]]
+    F f;
+
+    template <class Input>
+    struct impl
+    {
+        static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>>,
+                "transform_batch accepts single argument, use make_tuple() stage for multiple arguments");
+
+        using value_type = std::remove_cvref_t<Input>;
+
+        static_assert(std::is_invocable_v<F&, std::span<const value_type>, std::span<Out>>,
+                "transform_batch function should be callable as f(std::span<const In>, std::span<Out>)");
+
+        using input_type = Input;
+        using output_type = Out;
+        using stage_type = transform_batch_stage;
+
+        std::size_t batch_size;
+
+        [[no_unique_address]]
+        F f;
+
+        std::vector<value_type> inputs = {};
+        std::vector<Out> outputs = {};
+
+        template <class Next>
+        void flush(Next& next)
+        {
+            if (inputs.empty()) {
+                return;
+            }
+            const std::size_t n = inputs.size();
+            outputs.resize(n);
+            std::invoke(f, std::span<const value_type>(inputs), std::span<Out>(outputs.data(), n));
+            for (std::size_t i = 0; i < n && !next.done(); ++i) {
+                next.process_incremental(std::move(outputs[i]));
+            }
+            inputs.clear();
+        }
+
+        template <class Next>
+        void process_incremental(Input&& input, Next&& next)
+        {
+            if (inputs.capacity() == 0) {
+                inputs.reserve(batch_size);
+            }
+            inputs.emplace_back((Input&&) input);
+            if (inputs.size() == batch_size) {
+                flush(next);
+            }
+        }
+
+        template <class Next>
+        void size_hint(const std::size_t n, Next&& next)
+        {
+            next.size_hint(n);
+        }
+
+        template <class Next>
+        decltype(auto) end(Next&& next)
+        {
+            if (!next.done()) {
+                flush(next);
+            }
+            return next.end();
+        }
+    };
+
+    template <class Input>
+    auto make_impl() const &
+    {
+        return impl<Input>{batch_size, f};
+    }
+
+    template <class Input>
+    auto make_impl() &&
+    {
+        return impl<Input>{batch_size, (F&&) f};
+    }
+};
+
+} // namespace stages
+} // namespace detail
+
+inline namespace stages {
+
+// Transform for batched or vectorized functions (ML scoring, bulk lookups, SIMD hashing):
+// inputs are buffered and f(std::span<const In> inputs, std::span<Out> outputs) is called for up to
+// 'batch_size' of them at once, outputs[i] should be set for inputs[i]. Outputs are passed further in order.
+// The last incomplete batch is processed at the end of input, remaining outputs of a batch
+// are dropped when the next stages are done (e.g. take_n()).
+// Out is deduced from f with non-template call operator, specify it otherwise: transform_batch<Out>(n, f).
+// Throws std::invalid_argument if batch_size is 0.
+template <class Out = void, class F>
+auto transform_batch(const std::size_t batch_size, F&& f)
+{
+    using output_type = std::conditional_t<std::is_void_v<Out>, detail::batch_output_t<F>, Out>;
+    static_assert(!std::is_void_v<output_type>,
+            "transform_batch can't deduce output type from f, specify it explicitly: transform_batch<Out>(batch_size, f)");
+    static_assert(std::is_default_constructible_v<output_type>, "transform_batch requires default constructible output type");
+
+    if (batch_size == 0) {
+        throw std::invalid_argument("transform_batch: batch_size should be positive");
+    }
+    return detail::stages::transform_batch_stage<output_type, std::remove_cvref_t<F>>{batch_size, (F&&) f};
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,386 @@
+#pragma once
+
+#include "descend/args.hpp"
+#include "descend/stage_styles.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace descend {
+
+// Result of write_lines() and write_records() sinks
+struct write_result
+{
+    std::uint64_t bytes = 0;
+    std::uint64_t records = 0;
+
+    friend bool operator == (const write_result&, const write_result&) = default;
+};
+
+struct write_options
+{
+    // Output is collected in a buffer of this size and written with one system call when it is full
+    std::size_t buffer_size = std::size_t{1} << 20;
+    // Bypass the page cache with O_DIRECT for output opened by path, if the file system supports it
+    // (otherwise it is silently ignored). Use for large outputs which are not read back soon
+    bool direct = false;
+    // write_lines(): separator of multiple arguments in a line
+    char separator = ' ';
+};
+
+namespace detail {
+
+// Writes into file descriptor through a large buffer, every flush is a single write()/writev() call
+// (repeated only on partial writes). Throws std::system_error on errors.
+class buffered_fd_writer
+{
+public:
+    // O_DIRECT requires aligned buffer, sizes and file offsets
+    static constexpr std::size_t direct_alignment = 4096;
+
+    buffered_fd_writer(const int fd, const bool owns_fd, const write_options& options)
+        : m_fd(fd)
+        , m_owns_fd(owns_fd)
+        , m_capacity(std::max(round_up(options.buffer_size), 2 * direct_alignment))
+        , m_buffer(static_cast<char*>(::operator new(m_capacity, std::align_val_t{direct_alignment})))
+    {
+#ifdef O_DIRECT
+        if (options.direct && owns_fd) {
+            const int flags = ::fcntl(fd, F_GETFL);
+            m_direct = flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_DIRECT) == 0;
+        }
+#endif
+    }
+
+    buffered_fd_writer(buffered_fd_writer&& other) noexcept
+        : m_fd(std::exchange(other.m_fd, -1))
+        , m_owns_fd(std::exchange(other.m_owns_fd, false))
+        , m_direct(other.m_direct)
+        , m_capacity(other.m_capacity)
+        , m_buffer(std::move(other.m_buffer))
+        , m_used(other.m_used)
+        , m_written(other.m_written)
+    {}
+
+    buffered_fd_writer& operator = (buffered_fd_writer&&) = delete;
+
+    ~buffered_fd_writer()
+    {
+        if (m_owns_fd && m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    // Pointer to at least n (not greater than 4096) bytes of the buffer to format into, see commit()
+    char* reserve(const std::size_t n)
+    {
+        if (m_capacity - m_used < n) {
+            flush();
+        }
+        return m_buffer.get() + m_used;
+    }
+
+    void commit(const std::size_t n) noexcept
+    { m_used += n; }
+
+    void append(const char* data, const std::size_t n)
+    {
+        if (n <= m_capacity - m_used) {
+            std::memcpy(m_buffer.get() + m_used, data, n);
+            m_used += n;
+        }
+        else if (n < m_capacity / 2 || m_direct) {
+            // O_DIRECT can write only from the aligned buffer
+            for (std::size_t done = 0; done < n; ) {
+                const std::size_t chunk = std::min(n - done, m_capacity - m_used);
+                std::memcpy(m_buffer.get() + m_used, data + done, chunk);
+                m_used += chunk;
+                done += chunk;
+                if (m_used == m_capacity) {
+                    flush();
+                }
+            }
+        }
+        else {
+            // large piece is written together with the buffer without copying
+            iovec parts[2] = {{m_buffer.get(), m_used}, {const_cast<char*>(data), n}};
+            write_all(parts, 2);
+            m_used = 0;
+        }
+    }
+
+    std::size_t capacity() const noexcept
+    { return m_capacity; }
+
+    // Bytes written and buffered
+    std::uint64_t bytes() const noexcept
+    { return m_written + m_used; }
+
+    void flush()
+    {
+        std::size_t size = m_used;
+        if (m_direct) {
+            size = m_used / direct_alignment * direct_alignment; // the tail is kept till the next flush
+        }
+        iovec part = {m_buffer.get(), size};
+        write_all(&part, 1);
+        std::memmove(m_buffer.get(), m_buffer.get() + size, m_used - size);
+        m_used -= size;
+    }
+
+    // Writes everything including unaligned O_DIRECT tail, after that O_DIRECT is off.
+    // Owned file is closed by the destructor
+    void finish()
+    {
+        flush();
+#ifdef O_DIRECT
+        if (m_direct && m_used != 0) {
+            // unaligned tail is written without O_DIRECT
+            ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+            m_direct = false;
+            flush();
+        }
+#endif
+    }
+
+private:
+    struct aligned_delete
+    {
+        void operator () (char* p) const noexcept
+        { ::operator delete(p, std::align_val_t{direct_alignment}); }
+    };
+
+    static constexpr std::size_t round_up(const std::size_t n) noexcept
+    { return (n + direct_alignment - 1) / direct_alignment * direct_alignment; }
+
+    void write_all(iovec* parts, int count)
+    {
+        while (count != 0) {
+            const ssize_t result = count == 1 ? ::write(m_fd, parts->iov_base, parts->iov_len) : ::writev(m_fd, parts, count);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "write: write failed");
+            }
+            auto written = static_cast<std::size_t>(result);
+            m_written += written;
+            // skip what was written, partial writes are continued
+            while (count != 0 && written >= parts->iov_len) {
+                written -= parts->iov_len;
+                ++parts;
+                --count;
+            }
+            if (count != 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + written;
+                parts->iov_len -= written;
+            }
+        }
+    }
+
+    int m_fd;
+    bool m_owns_fd;
+    bool m_direct = false;
+    std::size_t m_capacity;
+    std::unique_ptr<char, aligned_delete> m_buffer;
+    std::size_t m_used = 0;
+    std::uint64_t m_written = 0;
+};
+
+inline int open_for_write(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "write: can't open " + path);
+    }
+    return fd;
+}
+
+namespace stages {
+
+// Formats arithmetic values with std::to_chars, copies strings
+struct lines_format
+{
+    char separator;
+
+    template <class T>
+    static consteval void check_line_argument()
+    {
+        static_assert(std::is_arithmetic_v<std::remove_cvref_t<T>> || std::is_convertible_v<T, std::string_view>,
+                "write_lines() accepts arithmetic and string-like arguments");
+    }
+
+    template <class T>
+    static void write_value(buffered_fd_writer& writer, T&& value)
+    {
+        using type = std::remove_cvref_t<T>;
+        if constexpr (std::is_same_v<type, bool>) {
+            writer.append(value ? "true" : "false", value ? 4 : 5);
+        }
+        else if constexpr (std::is_same_v<type, char>) {
+            writer.append(&value, 1);
+        }
+        else if constexpr (std::is_arithmetic_v<type>) {
+            constexpr std::size_t max_chars = 64; // enough for any integer and the shortest representation of floating point
+            char* first = writer.reserve(max_chars);
+            const auto result = std::to_chars(first, first + max_chars, value);
+            writer.commit(static_cast<std::size_t>(result.ptr - first));
+        }
+        else {
+            const std::string_view str((T&&) value);
+            writer.append(str.data(), str.size());
+        }
+    }
+
+    template <class Input>
+    void write(buffered_fd_writer& writer, Input&& input) const
+    {
+        args_invoke([this, &writer] <class... Args> (Args&&... values) {
+            (check_line_argument<Args&&>(), ...);
+            bool first = true;
+            ((first ? void(first = false) : writer.append(&separator, 1), write_value(writer, (Args&&) values)), ...);
+            writer.append("\n", 1);
+        }, (Input&&) input);
+    }
+};
+
+// Copies object representation of trivially copyable T
+template <class T>
+struct records_format
+{
+    static_assert(std::is_trivially_copyable_v<T>, "write_records<T>() requires trivially copyable T");
+
+    template <class Input>
+    void write(buffered_fd_writer& writer, Input&& input) const
+    {
+        static_assert(!is_specialization_of_v<args, std::remove_cvref_t<Input>> && std::is_convertible_v<Input&&, const T&>,
+                "write_records<T>() accepts single argument convertible to const T&");
+        const T& record = input;
+        writer.append(reinterpret_cast<const char*>(&record), sizeof(T));
+    }
+};
+
+// Terminal sink writing every element with Format through the writer created with the stage.
+// All chains created from the stage (e.g. groups of map_group_by) share the writer,
+// so grouped output goes into one file, which is opened and truncated only once.
+// Every chain reports bytes and records written by itself.
+template <class Format>
+struct write_stage
+{
+    static constexpr auto style = stage_styles::incremental_to_complete;
+
+    std::shared_ptr<buffered_fd_writer> writer;
+    Format format;
+
+    template <class Input>
+    struct impl
+    {
+        using input_type = Input;
+        using output_type = write_result;
+        using stage_type = write_stage;
+
+        std::shared_ptr<buffered_fd_writer> writer;
+        Format format;
+        std::uint64_t bytes = 0;
+        std::uint64_t records = 0;
+
+        template <class Next>
+        void process_incremental(Input&& input, Next&&)
+        {
+            const std::uint64_t before = writer->bytes();
+            format.write(*writer, (Input&&) input);
+            bytes += writer->bytes() - before;
+            ++records;
+        }
+
+        template <class Next>
+        decltype(auto) end(Next&& next)
+        {
+            writer->finish();
+            return next.process_complete(write_result{bytes, records});
+        }
+    };
+
+    template <class Input>
+    auto make_impl() const
+    {
+        return impl<Input>{writer, format};
+    }
+};
+
+inline std::shared_ptr<buffered_fd_writer> make_shared_writer(const int fd, const write_options& options)
+{
+    return std::make_shared<buffered_fd_writer>(fd, false, options);
+}
+
+inline std::shared_ptr<buffered_fd_writer> make_shared_writer(const std::string& path, const write_options& options)
+{
+    const int fd = open_for_write(path);
+    try {
+        return std::make_shared<buffered_fd_writer>(fd, true, options);
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+} // namespace stages
+} // namespace detail
+
+inline namespace stages {
+
+// Writes every element as a line of text into file descriptor 'fd' (which is not closed) or a file at 'path'
+// (created or truncated when the stage is created, closed with the last copy of the stage and its chains),
+// returns write_result with number of bytes and lines.
+// Inside map_group_by and group_by all groups write into the same file.
+// Arithmetic values are formatted with std::to_chars, strings are copied, arguments of multi-argument input
+// are separated with options.separator. Output is collected in a large buffer written with single
+// write()/writev() calls. POSIX only, include descend/stages/write.hpp separately.
+// Throws std::system_error on I/O errors.
+//
+//      dd::apply(values, dd::transform(...), dd::write_lines("out.txt"));
+//      dd::apply(columns(ts, price), dd::write_lines(STDOUT_FILENO, {.separator = '\t'}));
+inline auto write_lines(const int fd, const write_options& options = {})
+{
+    return detail::stages::write_stage<detail::stages::lines_format>{
+        detail::stages::make_shared_writer(fd, options), {options.separator}};
+}
+
+inline auto write_lines(const std::string& path, const write_options& options = {})
+{
+    return detail::stages::write_stage<detail::stages::lines_format>{
+        detail::stages::make_shared_writer(path, options), {options.separator}};
+}
+
+// Writes trivially copyable records back to back as raw bytes (can be read with mmap_records<T>()),
+// returns write_result with number of bytes and records. See write_lines() for the details.
+template <class T>
+auto write_records(const int fd, const write_options& options = {})
+{
+    return detail::stages::write_stage<detail::stages::records_format<T>>{detail::stages::make_shared_writer(fd, options), {}};
+}
+
+template <class T>
+auto write_records(const std::string& path, const write_options& options = {})
+{
+    return detail::stages::write_stage<detail::stages::records_format<T>>{detail::stages::make_shared_writer(path, options), {}};
+}
+
+} // namespace stages
+} // namespace descend
@@ -0,0 +1,589 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace descend {
+
+// How uring_file() reads blocks
+enum class read_backend
+{
+    automatic,    // io_uring if the kernel allows it, pread_thread otherwise
+    io_uring,     // io_uring only, std::system_error if it is not available
+    pread_thread, // pread() in a separate thread
+};
+
+namespace detail {
+
+// Block buffers are aligned for O_DIRECT-friendly reads and to avoid sharing cache lines between blocks
+inline constexpr std::size_t file_block_alignment = 4096;
+
+class file_block_buffers
+{
+public:
+    file_block_buffers(const std::size_t block_size, const std::size_t count)
+        : m_stride((block_size + file_block_alignment - 1) / file_block_alignment * file_block_alignment)
+        , m_data(static_cast<std::byte*>(::operator new(m_stride * count, std::align_val_t{file_block_alignment})))
+    {}
+
+    std::byte* operator [] (const std::size_t i) const noexcept
+    { return m_data.get() + i * m_stride; }
+
+private:
+    struct aligned_delete
+    {
+        void operator () (std::byte* p) const noexcept
+        { ::operator delete(p, std::align_val_t{file_block_alignment}); }
+    };
+
+    std::size_t m_stride;
+    std::unique_ptr<std::byte, aligned_delete> m_data;
+};
+
+// Minimal io_uring with raw syscalls: a submission and a completion ring mapped from the kernel.
+// Single-threaded, the owner submits and reaps. Throws std::system_error if io_uring can't be set up
+// (old kernel, disabled with sysctl or seccomp) or doesn't support IORING_OP_READ (kernels before 5.6
+// accept the setup, but fail every read with EINVAL).
+class io_uring_queue
+{
+public:
+    explicit io_uring_queue(const unsigned entries)
+    {
+        io_uring_params params{};
+        const long fd = ::syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "uring_file: io_uring_setup failed");
+        }
+        m_fd = static_cast<int>(fd);
+        if (!supports_read(m_fd)) {
+            ::close(m_fd);
+            throw std::system_error(EOPNOTSUPP, std::generic_category(), "uring_file: io_uring doesn't support IORING_OP_READ");
+        }
+
+        m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+        }
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        m_sq_ring = map(m_sq_ring_size, IORING_OFF_SQ_RING);
+        m_cq_ring = single_mmap ? m_sq_ring : map(m_cq_ring_size, IORING_OFF_CQ_RING);
+        m_sqes = static_cast<io_uring_sqe*>(map(m_sqes_size, IORING_OFF_SQES));
+
+        const auto sq = static_cast<std::byte*>(m_sq_ring);
+        m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        const auto cq = static_cast<std::byte*>(m_cq_ring);
+        m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    io_uring_queue(const io_uring_queue&) = delete;
+    io_uring_queue& operator = (const io_uring_queue&) = delete;
+
+    ~io_uring_queue()
+    {
+        unmap();
+    }
+
+    // The number of prepared and not submitted entries should not exceed 'entries'
+    void prepare_read(const int fd, std::byte* buffer, const std::size_t length, const std::uint64_t offset,
+                      const std::uint64_t user_data) noexcept
+    {
+        io_uring_sqe sqe{};
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+        sqe.len = static_cast<std::uint32_t>(length);
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        push(sqe);
+    }
+
+    void prepare_cancel(const std::uint64_t target, const std::uint64_t user_data) noexcept
+    {
+        io_uring_sqe sqe{};
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd = -1;
+        sqe.addr = target;
+        sqe.user_data = user_data;
+        push(sqe);
+    }
+
+    // Submits prepared entries and waits until at least 'wait_for' completions are available
+    void submit(const unsigned wait_for)
+    {
+        while (m_pending != 0 || wait_for != 0) {
+            const long result = ::syscall(__NR_io_uring_enter, m_fd, m_pending, wait_for,
+                                          wait_for != 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (result >= 0) {
+                m_pending -= std::min(m_pending, static_cast<unsigned>(result));
+                if (m_pending == 0 || wait_for != 0) {
+                    return;
+                }
+            }
+            else if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "uring_file: io_uring_enter failed");
+            }
+        }
+    }
+
+    // Calls f(user_data, result) for every available completion
+    template <class F>
+    void reap(F&& f)
+    {
+        unsigned head = *m_cq_head;
+        const unsigned tail = std::atomic_ref(*m_cq_tail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const io_uring_cqe cqe = m_cqes[head & m_cq_mask];
+            std::atomic_ref(*m_cq_head).store(head + 1, std::memory_order_release);
+            f(cqe.user_data, cqe.res);
+        }
+    }
+
+private:
+    // IORING_REGISTER_PROBE appeared in the same kernel (5.6) as IORING_OP_READ, so a failed probe means no reads
+    static bool supports_read(const int ring_fd) noexcept
+    {
+        constexpr unsigned max_ops = 256;
+        alignas(io_uring_probe) std::byte storage[sizeof(io_uring_probe) + max_ops * sizeof(io_uring_probe_op)] = {};
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, max_ops) < 0) {
+            return false;
+        }
+        constexpr unsigned read_op = IORING_OP_READ;
+        return probe->ops_len > read_op && (probe->ops[read_op].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    void* map(const std::size_t size, const std::uint64_t offset)
+    {
+        void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, static_cast<off_t>(offset));
+        if (address == MAP_FAILED) {
+            const int error = errno;
+            unmap();
+            throw std::system_error(error, std::generic_category(), "uring_file: can't map io_uring");
+        }
+        return address;
+    }
+
+    void unmap() noexcept
+    {
+        if (m_sqes != nullptr) {
+            ::munmap(m_sqes, m_sqes_size);
+        }
+        if (m_cq_ring != nullptr && m_cq_ring != m_sq_ring) {
+            ::munmap(m_cq_ring, m_cq_ring_size);
+        }
+        if (m_sq_ring != nullptr) {
+            ::munmap(m_sq_ring, m_sq_ring_size);
+        }
+        ::close(m_fd);
+    }
+
+    void push(const io_uring_sqe& sqe) noexcept
+    {
+        // the only producer, the entry is published to the kernel by the tail
+        const unsigned tail = *m_sq_tail;
+        const unsigned index = tail & m_sq_mask;
+        m_sqes[index] = sqe;
+        m_sq_array[index] = index;
+        std::atomic_ref(*m_sq_tail).store(tail + 1, std::memory_order_release);
+        ++m_pending;
+    }
+
+    int m_fd = -1;
+    void* m_sq_ring = nullptr;
+    void* m_cq_ring = nullptr;
+    io_uring_sqe* m_sqes = nullptr;
+    std::size_t m_sq_ring_size = 0;
+    std::size_t m_cq_ring_size = 0;
+    std::size_t m_sqes_size = 0;
+
+    unsigned* m_sq_tail = nullptr;
+    unsigned m_sq_mask = 0;
+    unsigned* m_sq_array = nullptr;
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned m_cq_mask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+    unsigned m_pending = 0;
+};
+
+// Geometry of the file split into blocks
+struct file_blocks
+{
+    int fd;
+    std::uint64_t file_size;
+    std::size_t block_size;
+    std::size_t queue_depth;
+
+    std::uint64_t count() const noexcept
+    { return (file_size + block_size - 1) / block_size; }
+
+    std::uint64_t offset(const std::uint64_t block) const noexcept
+    { return block * block_size; }
+
+    std::size_t length(const std::uint64_t block) const noexcept
+    { return static_cast<std::size_t>(std::min<std::uint64_t>(block_size, file_size - offset(block))); }
+};
+
+// Keeps up to queue_depth reads in flight in io_uring, block i is read into buffer i % queue_depth.
+// Blocks are passed to the callback in order; when it is done, outstanding reads are cancelled
+// and waited for (buffers are freed only after the kernel stops writing into them)
+template <class Done, class Callback>
+void iterate_file_blocks_uring(io_uring_queue& ring, const file_blocks& file, Done& done, Callback& callback)
+{
+    struct slot
+    {
+        std::size_t filled = 0;
+        bool in_flight = false;
+        int error = 0;
+    };
+
+    const auto depth = static_cast<unsigned>(file.queue_depth);
+    const file_block_buffers buffers{file.block_size, depth};
+    std::vector<slot> slots(depth);
+    std::vector<std::uint64_t> slot_block(depth);
+    unsigned in_flight = 0;
+    constexpr std::uint64_t cancel_tag = ~std::uint64_t{0};
+
+    const auto read_rest = [&] (const std::size_t i) {
+        const std::uint64_t block = slot_block[i];
+        ring.prepare_read(file.fd, buffers[i] + slots[i].filled, file.length(block) - slots[i].filled,
+                          file.offset(block) + slots[i].filled, i);
+        slots[i].in_flight = true;
+        ++in_flight;
+    };
+    const auto issue = [&] (const std::uint64_t block) {
+        const std::size_t i = static_cast<std::size_t>(block % depth);
+        slot_block[i] = block;
+        slots[i] = slot{};
+        read_rest(i);
+    };
+    const auto complete = [&] (const std::uint64_t user_data, const int result) {
+        if (user_data == cancel_tag) {
+            return;
+        }
+        slot& s = slots[user_data];
+        s.in_flight = false;
+        --in_flight;
+        if (result == -EINTR || result == -EAGAIN) {
+            read_rest(user_data);
+        }
+        else if (result < 0) {
+            s.error = -result;
+        }
+        else if (result > 0) {
+            s.filled += static_cast<std::size_t>(result);
+            if (s.filled < file.length(slot_block[user_data])) {
+                read_rest(user_data); // short read
+            }
+        }
+        // result == 0: the file was truncated, the block is passed with what was read
+    };
+
+    // Also on exceptions: the buffers can't be freed while the kernel may write into them
+    // (if waiting fails, the exception from the destructor terminates the program)
+    struct cancel_outstanding
+    {
+        io_uring_queue& ring;
+        std::vector<slot>& slots;
+        unsigned& in_flight;
+
+        ~cancel_outstanding()
+        {
+            ring.submit(0);
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                if (slots[i].in_flight) {
+                    ring.prepare_cancel(i, cancel_tag);
+                }
+            }
+            while (in_flight != 0) {
+                ring.submit(1);
+                ring.reap([this] (const std::uint64_t user_data, int) {
+                    if (user_data != cancel_tag) {
+                        slots[user_data].in_flight = false;
+                        --in_flight;
+                    }
+                });
+            }
+        }
+    } guard{ring, slots, in_flight};
+
+    const std::uint64_t blocks = file.count();
+    for (std::uint64_t block = 0; block < std::min<std::uint64_t>(depth, blocks); ++block) {
+        issue(block);
+    }
+    for (std::uint64_t block = 0; block < blocks && !done(); ++block) {
+        const std::size_t i = static_cast<std::size_t>(block % depth);
+        ring.submit(0);
+        ring.reap(complete);
+        while (slots[i].in_flight) {
+            ring.submit(1);
+            ring.reap(complete);
+        }
+        if (slots[i].error != 0) {
+            throw std::system_error(slots[i].error, std::generic_category(), "uring_file: read failed");
+        }
+        const std::size_t length = slots[i].filled;
+        callback(std::span<const std::byte>(buffers[i], length));
+        if (length < file.length(block)) {
+            return; // truncated
+        }
+        if (block + depth < blocks) {
+            issue(block + depth);
+        }
+    }
+}
+
+// Fallback without io_uring: a thread reads up to queue_depth blocks ahead with pread()
+template <class Done, class Callback>
+void iterate_file_blocks_pread(const file_blocks& file, Done& done, Callback& callback)
+{
+    const file_block_buffers buffers{file.block_size, file.queue_depth};
+    std::vector<std::size_t> lengths(file.queue_depth);
+    std::vector<int> errors(file.queue_depth);
+    const std::uint64_t blocks = file.count();
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::uint64_t produced = 0;
+    std::uint64_t consumed = 0;
+    bool stopping = false;
+
+    const auto read_block = [&] (const std::uint64_t block, const std::size_t i) {
+        std::size_t filled = 0;
+        while (filled < file.length(block)) {
+            const ssize_t result = ::pread(file.fd, buffers[i] + filled, file.length(block) - filled,
+                                           static_cast<off_t>(file.offset(block) + filled));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0) {
+                errors[i] = errno;
+                break;
+            }
+            if (result == 0) {
+                break; // truncated
+            }
+            filled += static_cast<std::size_t>(result);
+        }
+        lengths[i] = filled;
+        return errors[i] == 0 && filled == file.length(block);
+    };
+
+    std::thread reader([&] {
+        for (std::uint64_t block = 0; block < blocks; ++block) {
+            {
+                std::unique_lock lock{mutex};
+                changed.wait(lock, [&] { return stopping || block < consumed + file.queue_depth; });
+                if (stopping) {
+                    return;
+                }
+            }
+            const bool complete = read_block(block, static_cast<std::size_t>(block % file.queue_depth));
+            {
+                const std::lock_guard lock{mutex};
+                produced = block + 1;
+            }
+            changed.notify_all();
+            if (!complete) {
+                return;
+            }
+        }
+    });
+
+    struct stop_reader
+    {
+        std::mutex& mutex;
+        std::condition_variable& changed;
+        bool& stopping;
+        std::thread& reader;
+
+        ~stop_reader()
+        {
+            {
+                const std::lock_guard lock{mutex};
+                stopping = true;
+            }
+            changed.notify_all();
+            reader.join();
+        }
+    } guard{mutex, changed, stopping, reader};
+
+    for (std::uint64_t block = 0; block < blocks && !done(); ++block) {
+        const std::size_t i = static_cast<std::size_t>(block % file.queue_depth);
+        {
+            std::unique_lock lock{mutex};
+            changed.wait(lock, [&] { return block < produced; });
+        }
+        if (errors[i] != 0) {
+            throw std::system_error(errors[i], std::generic_category(), "uring_file: read failed");
+        }
+        callback(std::span<const std::byte>(buffers[i], lengths[i]));
+        if (lengths[i] < file.length(block)) {
+            return; // truncated
+        }
+        {
+            const std::lock_guard lock{mutex};
+            consumed = block + 1;
+        }
+        changed.notify_all();
+    }
+}
+
+} // namespace detail
+
+// Source yielding consecutive blocks of a file as std::span<const std::byte> (block_size bytes, the last one may be shorter),
+// read asynchronously ahead of the chain so it doesn't stall on the disk. With io_uring up to queue_depth reads
+// are in flight, without it a thread reads up to queue_depth blocks ahead with pread(). When the chain is done
+// (e.g. take_n()), outstanding reads are cancelled. A block is valid only while it is processed, buffers are reused.
+// The file is opened by the constructor, the object is move-only and can be iterated several times.
+// Exact size hint is the number of blocks. Throws std::system_error on I/O errors.
+class uring_file_source
+{
+public:
+    using custom_source_tag = void;
+
+    template <class Self>
+    using output_type = std::span<const std::byte>;
+
+    // Throws std::invalid_argument if block_size or queue_depth is out of range
+    uring_file_source(const std::string& path, const std::size_t block_size, const std::size_t queue_depth, const read_backend backend)
+        : m_block_size(block_size)
+        , m_queue_depth(queue_depth)
+        , m_backend(backend)
+    {
+        if (block_size == 0 || block_size > max_block_size) {
+            throw std::invalid_argument("uring_file: block_size should be in (0, 1 GiB]");
+        }
+        if (queue_depth == 0 || queue_depth > max_queue_depth) {
+            throw std::invalid_argument("uring_file: queue_depth should be in (0, 4096]");
+        }
+        m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "uring_file: can't open " + path);
+        }
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0) {
+            const int error = errno;
+            ::close(m_fd);
+            throw std::system_error(error, std::generic_category(), "uring_file: can't stat " + path);
+        }
+        m_file_size = static_cast<std::uint64_t>(st.st_size);
+        ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    uring_file_source(uring_file_source&& other) noexcept
+        : m_fd(std::exchange(other.m_fd, -1))
+        , m_file_size(other.m_file_size)
+        , m_block_size(other.m_block_size)
+        , m_queue_depth(other.m_queue_depth)
+        , m_backend(other.m_backend)
+    {}
+
+    uring_file_source& operator = (uring_file_source&&) = delete;
+
+    ~uring_file_source()
+    {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    std::uint64_t file_size() const noexcept
+    { return m_file_size; }
+
+    std::size_t size() const noexcept
+    { return static_cast<std::size_t>(blocks().count()); }
+
+    // True if io_uring can be set up in this process and supports reads
+    static bool io_uring_available() noexcept
+    {
+        try {
+            detail::io_uring_queue ring{1};
+            return true;
+        }
+        catch (const std::system_error&) {
+            return false;
+        }
+    }
+
+    template <class Self, class Done, class Callback>
+    static void iterate(Self&& self, Done&& done, Callback&& callback)
+    {
+        const detail::file_blocks file = self.blocks();
+        if (file.file_size == 0) {
+            return;
+        }
+        std::optional<detail::io_uring_queue> ring;
+        if (self.m_backend != read_backend::pread_thread) {
+            try {
+                ring.emplace(static_cast<unsigned>(file.queue_depth));
+            }
+            catch (const std::system_error&) {
+                if (self.m_backend == read_backend::io_uring) {
+                    throw;
+                }
+            }
+        }
+        if (ring) {
+            detail::iterate_file_blocks_uring(*ring, file, done, callback);
+        }
+        else {
+            detail::iterate_file_blocks_pread(file, done, callback);
+        }
+    }
+
+private:
+    static constexpr std::size_t max_block_size = std::size_t{1} << 30;
+    static constexpr std::size_t max_queue_depth = 4096;
+
+    detail::file_blocks blocks() const noexcept
+    { return {m_fd, m_file_size, m_block_size, m_queue_depth}; }
+
+    int m_fd = -1;
+    std::uint64_t m_file_size = 0;
+    std::size_t m_block_size;
+    std::size_t m_queue_depth;
+    read_backend m_backend;
+};
+
+// Reads the file with io_uring (Linux only, include descend/uring_file.hpp separately) in blocks
+// of 'block_size' bytes with 'queue_depth' reads in flight, see uring_file_source:
+//
+//      dd::apply(dd::uring_file("events.log"), dd::transform(count_lines), dd::accumulate(0));
+inline uring_file_source uring_file(const std::string& path, const std::size_t block_size = std::size_t{1} << 20,
+                                    const std::size_t queue_depth = 8, const read_backend backend = read_backend::automatic)
+{
+    return uring_file_source{path, block_size, queue_depth, backend};
+}
+
+} // namespace descend
@@ -0,0 +1,166 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+#include "descend/co_apply.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+namespace dd = descend;
+
+struct pipe_fds
+{
+    int read = -1;
+    int write = -1;
+
+    pipe_fds()
+    {
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        read = fds[0];
+        write = fds[1];
+    }
+
+    ~pipe_fds()
+    {
+        close_write();
+        ::close(read);
+    }
+
+    void send(const std::string& data) const
+    {
+        REQUIRE(::write(write, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    }
+
+    void close_write()
+    {
+        if (write >= 0) {
+            ::close(write);
+            write = -1;
+        }
+    }
+};
+
+// Source without I/O: batches of a vector
+struct vector_batches
+{
+    std::vector<std::vector<int>> batches;
+    std::size_t next = 0;
+
+    dd::task<std::optional<std::vector<int>>> next_batch()
+    {
+        if (next == batches.size()) {
+            co_return std::nullopt;
+        }
+        co_return std::move(batches[next++]);
+    }
+};
+
+dd::task<int> sum_of_lines(dd::event_loop& loop, const int fd)
+{
+    co_return co_await dd::co_apply(dd::async_lines(loop, fd),
+            dd::transform([] (std::string_view line) { return std::stoi(std::string(line)); }),
+            dd::accumulate(0));
+}
+
+TEST_CASE("co_apply runs many pipelines over pipes in one thread")
+{
+    constexpr int pipelines = 200;
+    std::vector<pipe_fds> pipes(pipelines);
+    std::vector<int> sums(pipelines, -1);
+
+    dd::event_loop loop;
+    for (int i = 0; i < pipelines; ++i) {
+        loop.spawn([] (dd::event_loop& l, int fd, int& sum) -> dd::task<void> {
+            sum = co_await sum_of_lines(l, fd);
+        }(loop, pipes[static_cast<std::size_t>(i)].read, sums[static_cast<std::size_t>(i)]));
+    }
+    // pipelines are suspended waiting for data
+    for (int i = 0; i < pipelines; ++i) {
+        auto& p = pipes[static_cast<std::size_t>(i)];
+        p.send("1\n2\n" + std::to_string(i) + "\n1"); // the last line without '\n' is split between writes
+        p.send("0");
+        p.close_write();
+    }
+    loop.run();
+
+    for (int i = 0; i < pipelines; ++i) {
+        CHECK(sums[static_cast<std::size_t>(i)] == 1 + 2 + i + 10);
+    }
+}
+
+TEST_CASE("co_apply suspends until data is written by another thread")
+{
+    pipe_fds p;
+    std::thread writer([&p] {
+        for (int i = 0; i < 10; ++i) {
+            p.send("line " + std::to_string(i) + "\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        p.close_write();
+    });
+
+    dd::event_loop loop;
+    const auto lines = loop.run(dd::co_apply(dd::async_lines(loop, p.read, 4),
+            dd::transform([] (std::string_view line) { return std::string(line); }),
+            dd::to<std::vector>()));
+    writer.join();
+    REQUIRE(lines.size() == 10);
+    CHECK(lines[0] == "line 0");
+    CHECK(lines[9] == "line 9");
+}
+
+TEST_CASE("co_apply stops reading when the chain is done")
+{
+    pipe_fds p;
+    p.send("a\nb\nc\nd\n"); // the writer is not closed, reading further would wait forever
+    dd::event_loop loop;
+    const auto first = loop.run(dd::co_apply(dd::async_lines(loop, p.read),
+            dd::take_n(2),
+            dd::transform([] (std::string_view line) { return std::string(line); }),
+            dd::to<std::vector>()));
+    CHECK(first == std::vector<std::string>{"a", "b"});
+}
+
+TEST_CASE("co_apply with custom async source and errors")
+{
+    dd::event_loop loop;
+    CHECK(loop.run(dd::co_apply(vector_batches{{{1, 2}, {}, {3}}}, dd::accumulate(0))) == 6);
+    CHECK(loop.run(dd::co_apply(vector_batches{}, dd::count())) == 0);
+
+    // the chain is created for every coroutine, a stage can be reused
+    const auto stage = dd::filter([] (int x) { return x % 2 == 0; });
+    CHECK(loop.run(dd::co_apply(vector_batches{{{1, 2, 3, 4}}}, stage, dd::count())) == 2);
+
+    pipe_fds p;
+    p.close_write();
+    CHECK(loop.run(dd::co_apply(dd::async_lines(loop, p.read), dd::count())) == 0);
+
+    const int closed = ::dup(p.read);
+    ::close(closed);
+    CHECK_THROWS_AS(dd::async_lines(loop, closed), std::system_error);
+
+    const auto failing = [] (dd::event_loop& l, int fd) -> dd::task<std::size_t> {
+        co_return co_await dd::co_apply(dd::async_lines(l, fd),
+                dd::transform([] (std::string_view) -> int { throw std::runtime_error("bad line"); }),
+                dd::count());
+    };
+    pipe_fds q;
+    q.send("x\n");
+    q.close_write();
+    CHECK_THROWS_AS(loop.run(failing(loop, q.read)), std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,131 @@
+#include <doctest.h>
+
+#include "descend/columns.hpp"
+#include "descend/descend.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+TEST_CASE("columns() yields args<> in lockstep")
+{
+    const std::vector<std::int64_t> ts = {10, 20, 30};
+    const std::vector<double> price = {1.5, 2.5, 3.5};
+    const std::vector<int> qty = {1, 2, 3};
+
+    auto result = dd::apply(
+        dd::columns(ts, price, qty),
+        dd::transform([] (const std::int64_t& t, const double& p, const int& q) {
+            return static_cast<double>(t) + p * q;
+        }),
+        dd::to<std::vector>()
+    );
+    CHECK(result == std::vector{11.5, 25.0, 40.5});
+}
+
+TEST_CASE("columns() element types follow unwrap_input rules per column")
+{
+    std::vector<int> a = {1, 2};
+    std::vector<std::string> b = {"x", "y"};
+    std::vector<double> c = {0.5, 1.5};
+
+    dd::apply(
+        dd::columns(a, std::ref(b), std::move(c)),
+        dd::for_each([] (auto&& x, auto&& y, auto&& z) {
+            static_assert(std::is_same_v<decltype(x), const int&>);
+            static_assert(std::is_same_v<decltype(y), std::string&>);
+            static_assert(std::is_same_v<decltype(z), double&&>);
+            y += "!";
+        })
+    );
+    CHECK(b == std::vector<std::string>{"x!", "y!"});
+
+    auto source = dd::columns(std::vector{1, 2}, std::list<long>{3, 4});
+    static_assert(!decltype(source)::is_contiguous);
+    dd::apply(
+        source,
+        dd::for_each([] (auto&& x, auto&& y) {
+            // source itself is passed as lvalue, owned columns are const
+            static_assert(std::is_same_v<decltype(x), const int&>);
+            static_assert(std::is_same_v<decltype(y), const long&>);
+        })
+    );
+    CHECK(source.size() == 2);
+}
+
+TEST_CASE("columns() provides sizes and contiguous columns")
+{
+    const std::vector<int> a = {1, 2, 3, 4};
+    const std::vector<float> b = {1.f, 2.f, 3.f, 4.f};
+
+    const auto source = dd::columns(a, b);
+    static_assert(decltype(source)::is_contiguous);
+    CHECK(source.size() == 4);
+    CHECK(source.column<1>().data() == b.data());
+    CHECK(source.column<1>().size() == 4);
+
+    const auto taken = dd::apply(source, dd::take_n(2), dd::count());
+    CHECK(taken == 2);
+
+    CHECK_THROWS_AS(dd::columns(a, std::vector<int>{1}), std::length_error);
+}
+
+TEST_CASE("size hint reserves memory in to<std::vector>")
+{
+    const std::vector<int> values(100, 1);
+
+    auto result = dd::apply(values, dd::transform([] (int x) { return x * 2; }), dd::to<std::vector>());
+    CHECK(result.capacity() == 100);
+
+    auto first10 = dd::apply(dd::columns(values), dd::take_n(10), dd::to<std::vector>());
+    CHECK(first10.capacity() == 10);
+}
+
+TEST_CASE("to_columns() collects args<> into struct-of-arrays")
+{
+    const std::vector<int> values = {1, 2, 3};
+
+    auto [indices, names, doubled] = dd::apply(
+        values,
+        dd::enumerate<std::size_t>(),
+        dd::zip_result([] (std::size_t, int x) { return x * 2; }),
+        dd::transform_arg<1>([] (int x) { return std::to_string(x); }),
+        dd::to_columns()
+    );
+    static_assert(std::is_same_v<decltype(indices), std::vector<std::size_t>>);
+    static_assert(std::is_same_v<decltype(doubled), std::vector<int>>);
+    static_assert(std::is_same_v<decltype(names), std::vector<std::string>>);
+
+    CHECK(indices == std::vector<std::size_t>{0, 1, 2});
+    CHECK(names == std::vector<std::string>{"1", "2", "3"});
+    CHECK(doubled == std::vector{2, 4, 6});
+    CHECK(doubled.capacity() == 3); // reserved from size hint
+}
+
+TEST_CASE("columns() -> to_columns() round trip")
+{
+    const std::vector<std::int64_t> ts = {1, 2, 3, 4};
+    const std::vector<double> price = {10.0, 20.0, 30.0, 40.0};
+
+    auto [even_ts, even_price] = dd::apply(
+        dd::columns(ts, price),
+        dd::filter([] (std::int64_t t, double) { return t % 2 == 0; }),
+        dd::to_columns<std::list>()
+    );
+    CHECK(even_ts == std::list<std::int64_t>{2, 4});
+    CHECK(even_price == std::list<double>{20.0, 40.0});
+
+    auto [single] = dd::apply(ts, dd::to_columns());
+    CHECK(single == ts);
+}
+
+} // namespace anonymous
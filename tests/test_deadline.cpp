@@ -0,0 +1,134 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+// Clock advanced by the test
+struct manual_clock
+{
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<manual_clock>;
+    static constexpr bool is_steady = true;
+
+    static inline time_point current{};
+    static time_point now() { return current; }
+};
+
+TEST_CASE("deadline drops elements after the time point and stops the source")
+{
+    using namespace std::chrono_literals;
+    manual_clock::current = manual_clock::time_point{};
+
+    int generated = 0;
+    const auto result = dd::apply(
+            dd::iota(0),
+            dd::transform([&generated] (int x) { ++generated; return x; }),
+            dd::deadline(manual_clock::time_point{10ns}, 4),
+            dd::transform([] (int x) { manual_clock::current += 1ns; return x; }),
+            dd::to<std::vector>());
+    static_assert(std::is_same_v<decltype(result), const dd::deadline_result<std::vector<int>>>);
+
+    // the clock is checked on elements 0, 4, 8 and 12, at the last one it is already 12ns
+    CHECK(result.truncated);
+    CHECK_FALSE(result.complete());
+    REQUIRE(result.value.size() == 12);
+    CHECK(result.value.back() == 11);
+    CHECK(generated == 13); // done() stopped the infinite source right after the dropped element
+}
+
+TEST_CASE("deadline result is complete when the input ends in time")
+{
+    using namespace std::chrono_literals;
+
+    const std::vector<int> input{1, 2, 3, 4, 5};
+    CHECK(dd::apply(input, dd::deadline(1h), dd::accumulate(0)) == dd::deadline_result<int>{15, false});
+
+    // deadline expired before the start: elements are dropped, but empty input is still complete
+    manual_clock::current = manual_clock::time_point{100ns};
+    CHECK(dd::apply(std::vector<int>{}, dd::deadline(manual_clock::time_point{10ns}), dd::count()).complete());
+    const auto expired = dd::apply(input, dd::deadline(manual_clock::time_point{10ns}), dd::count());
+    CHECK(expired.truncated);
+    CHECK(expired.value == 0);
+
+    // void result of the next stages
+    int sum = 0;
+    const auto visited = dd::apply(input, dd::deadline(1h, 1), dd::for_each([&sum] (int x) { sum += x; }));
+    static_assert(std::is_same_v<decltype(visited), const dd::deadline_result<void>>);
+    CHECK(visited.complete());
+    CHECK(sum == 15);
+
+    // size hint is passed through
+    CHECK(dd::apply(input, dd::deadline(1h), dd::to<std::vector>()).value.capacity() == 5);
+}
+
+TEST_CASE("deadline honours done() of the next stages")
+{
+    using namespace std::chrono_literals;
+
+    // take_n() is done long before the budget is exhausted: the infinite source is stopped right away
+    int generated = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto first = dd::apply(
+            dd::iota(0),
+            dd::transform([&generated] (int x) { ++generated; return x; }),
+            dd::deadline(10s),
+            dd::take_n(3),
+            dd::to<std::vector>());
+    CHECK(std::chrono::steady_clock::now() - start < 5s);
+    CHECK(first.complete());
+    CHECK(first.value == std::vector{0, 1, 2});
+    CHECK(generated == 3);
+
+    // the budget is used up exactly when take_n() is done: nothing was dropped, the result is complete
+    manual_clock::current = manual_clock::time_point{};
+    const auto in_time = dd::apply(
+            dd::iota(0),
+            dd::deadline(manual_clock::time_point{2ns}, 1),
+            dd::transform([] (int x) { manual_clock::current += 1ns; return x; }),
+            dd::take_n(2),
+            dd::to<std::vector>());
+    CHECK(in_time.complete());
+    CHECK(in_time.value == std::vector{0, 1});
+
+    // expired before take_n() got enough elements
+    manual_clock::current = manual_clock::time_point{};
+    const auto late = dd::apply(
+            dd::iota(0),
+            dd::deadline(manual_clock::time_point{2ns}, 1),
+            dd::transform([] (int x) { manual_clock::current += 1ns; return x; }),
+            dd::take_n(5),
+            dd::to<std::vector>());
+    CHECK(late.truncated);
+    CHECK(late.value == std::vector{0, 1});
+}
+
+TEST_CASE("deadline with steady_clock budget and errors")
+{
+    using namespace std::chrono_literals;
+
+    const auto result = dd::apply(
+            dd::iota(0),
+            dd::deadline(20ms, 1),
+            dd::transform([] (int x) { std::this_thread::sleep_for(1ms); return x; }),
+            dd::count());
+    CHECK(result.truncated);
+    CHECK(result.value >= 1);
+    CHECK(result.value <= 20);
+
+    CHECK_THROWS_AS(dd::deadline(1s, 0), std::invalid_argument);
+    CHECK_THROWS_AS(dd::deadline(manual_clock::time_point{}, 0), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,145 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+struct Record
+{
+    std::string name;
+    int value;
+};
+
+const std::vector<Record> records = {
+    {"apple", 1}, {"banana", 2}, {"apple", 3}, {"cherry", 4}, {"banana", 5}, {"apple", 6}
+};
+
+TEST_CASE("map_group_by with owning_key and ordered map")
+{
+    auto result = dd::apply(
+        records,
+        dd::map_group_by<std::map>(
+            dd::owning_key<std::string>([] (const Record& r) { return std::string_view{r.name}; }),
+            dd::transform(&Record::value),
+            dd::accumulate()
+        ),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+
+    static_assert(std::is_same_v<decltype(result), std::vector<std::pair<std::string, int>>>);
+    CHECK(result == std::vector<std::pair<std::string, int>>{
+            {"apple", 10}, {"banana", 7}, {"cherry", 4}});
+}
+
+TEST_CASE("map_group_by with owning_key and unordered map")
+{
+    auto result = dd::apply(
+        records,
+        dd::map_group_by<std::unordered_map>(
+            dd::owning_key<std::string>([] (const Record& r) { return std::string_view{r.name}; }),
+            dd::count()
+        ),
+        dd::to<std::map>()
+    );
+
+    static_assert(std::is_same_v<decltype(result), std::map<std::string, std::size_t>>);
+    CHECK(result == std::map<std::string, std::size_t>{
+            {"apple", 3}, {"banana", 2}, {"cherry", 1}});
+}
+
+TEST_CASE("map_group_by with owning_key over temporary records")
+{
+    // keys are views into records which don't outlive the processing of the element
+    auto result = dd::apply(
+        dd::iota(0, 6),
+        dd::transform([] (int i) { return Record{std::string(i % 2 == 0 ? "even" : "odd"), i}; }),
+        dd::map_group_by<std::unordered_map>(
+            dd::owning_key<std::string>([] (const Record& r) { return std::string_view{r.name}; }),
+            dd::count()
+        ),
+        dd::to<std::map>()
+    );
+
+    CHECK(result == std::map<std::string, std::size_t>{{"even", 3}, {"odd", 3}});
+}
+
+struct Event
+{
+    std::int32_t user_id;
+    std::int16_t kind;
+    std::string country;
+};
+
+const std::vector<Event> events = {
+    {7, 1, "DE"}, {-3, 2, "US"}, {7, 1, "DE"}, {7, 1, "FR"}, {-3, 2, "US"}, {100, -5, "DE"}
+};
+
+TEST_CASE("packed_key orders like field-by-field comparison")
+{
+    const auto key = dd::packed_key(&Event::user_id, &Event::kind, dd::packed_string<4>(&Event::country));
+
+    for (const auto& a : events) {
+        for (const auto& b : events) {
+            const auto expected = std::tie(a.user_id, a.kind, a.country) <=> std::tie(b.user_id, b.kind, b.country);
+            CHECK((key(a) <=> key(b)) == expected);
+        }
+    }
+
+    CHECK(key(Event{1, 0, "a"}) < key(Event{1, 0, "ab"}));
+    CHECK(key(Event{1, 0, ""}) < key(Event{1, 0, std::string("\0", 1)}));
+    CHECK(key(Event{1, 0, "a"}).unpack() == std::tuple<std::int32_t, std::int16_t, std::string>{1, 0, "a"});
+
+    CHECK_THROWS_AS(key(Event{1, 0, "ABCDE"}), std::length_error);
+}
+
+TEST_CASE("map_group_by with packed_key unpacks key fields")
+{
+    SUBCASE("ordered map") {
+        auto result = dd::apply(
+            events,
+            dd::map_group_by<std::map>(
+                dd::packed_key(&Event::user_id, &Event::kind, dd::packed_string<4>(&Event::country)),
+                dd::count()
+            ),
+            dd::make_tuple(),
+            dd::to<std::vector>()
+        );
+
+        using tuple_type = std::tuple<std::int32_t, std::int16_t, std::string, std::size_t>;
+        static_assert(std::is_same_v<decltype(result), std::vector<tuple_type>>);
+        CHECK(result == std::vector<tuple_type>{
+                {-3, 2, "US", 2}, {7, 1, "DE", 2}, {7, 1, "FR", 1}, {100, -5, "DE", 1}});
+    }
+
+    SUBCASE("unordered map") {
+        auto result = dd::apply(
+            events,
+            dd::map_group_by<std::unordered_map>(
+                dd::packed_key(&Event::user_id, &Event::kind),
+                dd::count()
+            ),
+            dd::make_tuple(),
+            dd::to<std::vector>(),
+            dd::sort()
+        );
+
+        using tuple_type = std::tuple<std::int32_t, std::int16_t, std::size_t>;
+        CHECK(result == std::vector<tuple_type>{{-3, 2, 2}, {7, 1, 3}, {100, -5, 1}});
+    }
+}
+
+} // namespace anonymous
@@ -0,0 +1,140 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+TEST_CASE("histogram counts values into bins by edges")
+{
+    const std::vector<double> values = {-1.0, 0.0, 0.5, 1.0, 2.5, 9.99, 10.0, 42.0, std::nan("")};
+    const auto hist = dd::apply(values, dd::histogram({0.0, 1.0, 5.0, 10.0}));
+
+    REQUIRE(hist.bins() == 3);
+    CHECK(hist.count(0) == 2); // 0.0, 0.5
+    CHECK(hist.count(1) == 2); // 1.0, 2.5
+    CHECK(hist.count(2) == 1); // 9.99
+    CHECK(hist.underflow() == 2); // -1.0, NaN
+    CHECK(hist.overflow() == 2); // 10.0, 42.0
+    CHECK(hist.total() == values.size());
+
+    CHECK_THROWS_AS((void) dd::histogram({1.0}), std::invalid_argument);
+    CHECK_THROWS_AS((void) dd::histogram({1.0, 1.0}), std::invalid_argument);
+}
+
+TEST_CASE("histogram agrees with linear search for many values and merges")
+{
+    std::vector<double> edges;
+    for (int i = 0; i <= 37; ++i) {
+        edges.push_back(i * i);
+    }
+    std::vector<int> values;
+    for (int i = -50; i < 1500; ++i) {
+        values.push_back(i);
+    }
+    const auto hist = dd::apply(values, dd::histogram(edges));
+    for (std::size_t bin = 0; bin < hist.bins(); ++bin) {
+        std::uint64_t expected = 0;
+        for (const int v : values) {
+            expected += (v >= edges[bin] && v < edges[bin + 1]) ? 1 : 0;
+        }
+        CHECK(hist.count(bin) == expected);
+    }
+
+    auto merged = hist;
+    merged.merge(hist);
+    CHECK(merged.total() == 2 * values.size());
+    CHECK(merged.count(5) == 2 * hist.count(5));
+    CHECK_THROWS_AS(merged.merge(dd::fixed_bin_histogram({0.0, 1.0})), std::invalid_argument);
+}
+
+TEST_CASE("log_histogram bins have bounded relative width")
+{
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t v = 1; v < 100'000'000; v = v * 11 / 10 + 1) {
+        values.push_back(v);
+    }
+    const auto hist = dd::apply(values, dd::log_histogram(1, 1e9, 2));
+    CHECK(hist.total() == values.size());
+    CHECK(hist.underflow() == 0);
+    CHECK(hist.overflow() == 0);
+
+    for (std::size_t i = 0; i < hist.bins(); ++i) {
+        const double lower = hist.lower(i);
+        const double upper = hist.lower(i + 1);
+        CHECK(upper > lower);
+        if (lower >= 100.0) {
+            CHECK((upper - lower) / lower <= 0.01 + 1e-12);
+        }
+    }
+    for (const std::uint64_t v : {std::uint64_t{7}, std::uint64_t{12345}, std::uint64_t{98'765'432}}) {
+        dd::log_linear_histogram single{1, 1e9, 2};
+        single.add(static_cast<double>(v));
+        const auto upper = single.value_at_quantile(0.5);
+        REQUIRE(upper.has_value());
+        CHECK(*upper > static_cast<double>(v));
+        CHECK(*upper <= static_cast<double>(v) * 1.01 + 1.0);
+    }
+
+    dd::log_linear_histogram edges{1000, 1e6, 3};
+    edges.add(-5.0);
+    edges.add(2e6);
+    edges.add(std::numeric_limits<double>::infinity());
+    edges.add(10.0); // below min: counted with min resolution
+    CHECK(edges.underflow() == 1);
+    CHECK(edges.overflow() == 2);
+    CHECK(edges.count(0) == 1);
+
+    CHECK_THROWS_AS((void) dd::log_histogram(0, 100, 2), std::invalid_argument);
+    CHECK_THROWS_AS((void) dd::log_histogram(1, 100, 6), std::invalid_argument);
+}
+
+TEST_CASE("log_histogram quantiles per group and merge")
+{
+    std::vector<int> values;
+    for (int i = 1; i <= 10'000; ++i) {
+        values.push_back(i);
+    }
+    const auto groups = dd::apply(
+        values,
+        dd::map_group_by<std::map>([] (int x) { return x % 2; }, dd::log_histogram(1, 1e6, 3)),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    REQUIRE(groups.size() == 2);
+    auto merged = groups[0].second;
+    merged.merge(groups[1].second);
+    CHECK(merged.total() == values.size());
+
+    const auto p99 = merged.value_at_quantile(0.99);
+    REQUIRE(p99.has_value());
+    CHECK(std::abs(*p99 - 9900.0) / 9900.0 < 0.002);
+    CHECK(!dd::log_linear_histogram(1, 100, 1).value_at_quantile(0.5).has_value());
+
+    // batches give the same counts as values added one by one
+    std::vector<double> doubles(values.begin(), values.end());
+    doubles.push_back(-1.0);
+    doubles.push_back(2e6);
+    dd::log_linear_histogram batched{1, 1e6, 3};
+    batched.add_batch(doubles);
+    dd::log_linear_histogram one_by_one{1, 1e6, 3};
+    for (const double x : doubles) {
+        one_by_one.add(x);
+    }
+    CHECK(batched.underflow() == 1);
+    CHECK(batched.overflow() == 1);
+    for (std::size_t i = 0; i < batched.bins(); ++i) {
+        CHECK(batched.count(i) == one_by_one.count(i));
+    }
+}
+
+} // namespace anonymous
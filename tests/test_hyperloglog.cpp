@@ -0,0 +1,104 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+std::vector<std::uint64_t> make_values(const std::uint64_t from, const std::uint64_t to)
+{
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t i = from; i < to; ++i) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+double relative_error(const double estimate, const double exact)
+{
+    return std::abs(estimate - exact) / exact;
+}
+
+TEST_CASE("count_distinct_approx is accurate for large cardinalities")
+{
+    const auto values = make_values(0, 200'000);
+
+    const std::size_t estimate = dd::apply(values, dd::count_distinct_approx());
+    // standard error for precision 14 is 0.8%
+    CHECK(relative_error(static_cast<double>(estimate), 200'000.0) < 0.03);
+
+    const std::size_t estimate_12 = dd::apply(values, dd::count_distinct_approx(12));
+    CHECK(relative_error(static_cast<double>(estimate_12), 200'000.0) < 0.06);
+}
+
+TEST_CASE("count_distinct_approx is (almost) exact for small cardinalities")
+{
+    std::vector<std::string> strings;
+    for (int repeat = 0; repeat < 10; ++repeat) {
+        for (int i = 0; i < 500; ++i) {
+            strings.push_back("user-" + std::to_string(i));
+        }
+    }
+    const std::size_t estimate = dd::apply(strings, dd::count_distinct_approx());
+    CHECK(estimate >= 498);
+    CHECK(estimate <= 502);
+
+    CHECK(dd::apply(std::vector<int>{}, dd::count_distinct_approx()) == 0);
+    CHECK(dd::apply(std::vector<int>{7, 7, 7}, dd::count_distinct_approx()) == 1);
+}
+
+TEST_CASE("hyperloglog sketches switch to dense representation and merge")
+{
+    const auto small = dd::apply(make_values(0, 100), dd::hyperloglog_sketch(12));
+    CHECK(small.is_sparse());
+    CHECK(small.memory_usage() < 1024);
+
+    const auto first = dd::apply(make_values(0, 60'000), dd::hyperloglog_sketch(12));
+    const auto second = dd::apply(make_values(40'000, 100'000), dd::hyperloglog_sketch(12));
+    const auto all = dd::apply(make_values(0, 100'000), dd::hyperloglog_sketch(12));
+    CHECK(!first.is_sparse());
+
+    auto merged = first;
+    merged.merge(second);
+    CHECK(merged.estimate() == all.estimate());
+
+    // sparse into dense and dense into sparse
+    auto sparse = small;
+    sparse.merge(first);
+    auto dense = first;
+    dense.merge(small);
+    CHECK(sparse.estimate() == dense.estimate());
+    CHECK(dense.estimate() == first.estimate()); // 0..100 are already in first
+
+    CHECK_THROWS_AS(merged.merge(dd::hyperloglog{14}), std::invalid_argument);
+    CHECK_THROWS_AS(dd::hyperloglog{3}, std::invalid_argument);
+    CHECK_THROWS_AS((void) dd::count_distinct_approx(19), std::invalid_argument);
+    CHECK_THROWS_AS(dd::hyperloglog::validate(19), std::invalid_argument);
+    CHECK_NOTHROW((void) dd::count_distinct_approx(dd::hyperloglog::max_precision));
+}
+
+TEST_CASE("count_distinct_approx per group")
+{
+    const auto values = make_values(0, 30'000);
+    const auto groups = dd::apply(
+        values,
+        dd::map_group_by<std::map>([] (std::uint64_t x) { return x % 3; }, dd::count_distinct_approx()),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    REQUIRE(groups.size() == 3);
+    for (const auto& [key, estimate] : groups) {
+        CHECK(relative_error(static_cast<double>(estimate), 10'000.0) < 0.03);
+    }
+}
+
+} // namespace anonymous
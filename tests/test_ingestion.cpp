@@ -0,0 +1,127 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+#include "descend/ingestion.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+struct Event
+{
+    std::string endpoint;
+    int latency;
+};
+
+TEST_CASE("ingestion aggregates elements pushed by many threads")
+{
+    constexpr int producers = 4;
+    constexpr int per_producer = 20000;
+
+    auto pipeline = dd::ingestion<Event>({.capacity = 256},
+        dd::map_group_by<std::unordered_map>(&Event::endpoint, dd::transform(&Event::latency), dd::accumulate(std::int64_t{0})),
+        dd::make_pair(),
+        dd::to<std::vector>());
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&pipeline, p] {
+            for (int i = 0; i < per_producer; ++i) {
+                CHECK(pipeline.push(Event{"/api/" + std::to_string(i % 3), p + 1}));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto result = pipeline.finish();
+    REQUIRE(result.size() == 3);
+    std::int64_t total = 0;
+    for (const auto& [endpoint, sum] : result) {
+        total += sum;
+    }
+    CHECK(total == std::int64_t{per_producer} * (1 + 2 + 3 + 4));
+    CHECK(pipeline.dropped() == 0);
+    CHECK_FALSE(pipeline.push(Event{"/late", 1})); // after finish()
+}
+
+TEST_CASE("ingestion keeps order of a single producer and flush() waits for processing")
+{
+    std::vector<int> seen;
+    auto pipeline = dd::ingestion<int>({.capacity = 16},
+        dd::transform([&seen] (int x) { seen.push_back(x); return x; }),
+        dd::to<std::vector>());
+    for (int i = 0; i < 1000; ++i) {
+        pipeline.push(i);
+    }
+    pipeline.flush();
+    CHECK(seen.size() == 1000); // the consumer is idle after flush(), safe to read
+
+    const auto result = pipeline.finish();
+    REQUIRE(result.size() == 1000);
+    CHECK(result.front() == 0);
+    CHECK(result.back() == 999);
+}
+
+TEST_CASE("ingestion drop policy and done chain")
+{
+    std::atomic<bool> release{false};
+    auto slow = dd::ingestion<int>({.capacity = 4, .overflow = dd::overflow_policy::drop},
+        dd::transform([&release] (int x) {
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+            return x;
+        }),
+        dd::count());
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i) {
+        accepted += slow.push(i) ? 1 : 0;
+    }
+    CHECK(accepted <= 5); // the queue and the element being processed
+    CHECK(slow.dropped() == static_cast<std::uint64_t>(100 - accepted));
+    release = true;
+    CHECK(slow.finish() == static_cast<std::size_t>(accepted));
+
+    auto first = dd::ingestion<int>({}, dd::take_n(3), dd::to<std::vector>());
+    for (int i = 0; i < 100; ++i) {
+        first.push(i);
+    }
+    first.flush();
+    CHECK_FALSE(first.push(100));
+    CHECK(first.finish() == std::vector{0, 1, 2});
+}
+
+TEST_CASE("ingestion errors")
+{
+    CHECK_THROWS_AS(dd::ingestion<int>({.capacity = 0}, dd::count()), std::invalid_argument);
+
+    auto failing = dd::ingestion<int>({},
+        dd::transform([] (int x) {
+            if (x == 5) {
+                throw std::runtime_error("bad element");
+            }
+            return x;
+        }),
+        dd::count());
+    for (int i = 0; i < 10; ++i) {
+        failing.push(i);
+    }
+    CHECK_THROWS_AS(failing.finish(), std::runtime_error);
+
+    // destroyed without finish()
+    auto unfinished = dd::ingestion<std::string>({}, dd::count());
+    unfinished.push("a");
+}
+
+} // namespace
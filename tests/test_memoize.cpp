@@ -0,0 +1,94 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+TEST_CASE("memoize_transform gives the same results as transform")
+{
+    int calls = 0;
+    const auto square = [&calls] (int x) { ++calls; return x * x; };
+
+    std::vector<int> input;
+    for (int i = 0; i < 1000; ++i) {
+        input.push_back(i % 10);
+    }
+
+    dd::memoize_counters counters;
+    const auto memoized = dd::apply(input, dd::memoize_transform(square, 16, std::ref(counters)), dd::to<std::vector>());
+    CHECK(calls == 10);
+    CHECK(counters.misses == 10);
+    CHECK(counters.hits == 990);
+    CHECK(counters.evictions == 0);
+
+    const auto expected = dd::apply(input, dd::transform([] (int x) { return x * x; }), dd::to<std::vector>());
+    CHECK(memoized == expected);
+    CHECK(memoized.capacity() == 1000); // size hint is passed through
+}
+
+TEST_CASE("memoize_transform evicts entries when the cache is full")
+{
+    int calls = 0;
+    const auto negate = [&calls] (long x) { ++calls; return -x; };
+
+    std::vector<long> input;
+    for (long round = 0; round < 3; ++round) {
+        for (long i = 0; i < 1000; ++i) {
+            input.push_back(i);
+        }
+    }
+
+    dd::memoize_counters counters;
+    const auto result = dd::apply(input, dd::memoize_transform(negate, 64, std::ref(counters)), dd::to<std::vector>());
+    REQUIRE(result.size() == input.size());
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        CHECK(result[i] == -input[i]);
+    }
+    CHECK(counters.hits + counters.misses == input.size());
+    CHECK(counters.misses == static_cast<std::uint64_t>(calls));
+    CHECK(counters.misses - counters.evictions <= 64); // entries in the cache
+
+    CHECK_THROWS_AS((void) dd::memoize_transform(negate, 0), std::invalid_argument);
+}
+
+TEST_CASE("memoize_transform with string_view and multi-argument input")
+{
+    // string_views point into a buffer which is overwritten, keys are stored as std::string
+    std::vector<std::string> words = {"alpha", "beta", "alpha", "gamma", "beta", "alpha"};
+    std::vector<std::string_view> views(words.begin(), words.end());
+
+    int calls = 0;
+    const auto length = [&calls] (std::string_view s) { ++calls; return s.size(); };
+    const auto stage = dd::memoize_transform(length, 8);
+    CHECK(dd::apply(views, stage, dd::to<std::vector>()) == std::vector<std::size_t>{5, 4, 5, 5, 4, 5});
+    CHECK(calls == 3);
+
+    const std::vector<std::string> more = {"alpha", "delta", "beta"};
+    const auto joined = dd::apply(
+        more,
+        dd::enumerate<int>(),
+        dd::memoize_transform([] (int i, const std::string& s) { return std::to_string(i) + s; }, 8),
+        dd::to<std::vector>());
+    CHECK(joined == std::vector<std::string>{"0alpha", "1delta", "2beta"});
+
+    dd::memoize_counters counters;
+    const std::vector<std::string_view> pairs = {"a", "b", "a", "a"};
+    const auto tagged = dd::apply(
+        pairs,
+        dd::zip_result([] (std::string_view s) { return s == "a" ? 1 : 2; }),
+        dd::memoize_transform([] (std::string_view s, int tag) { return std::string(s) + std::to_string(tag); }, 8, std::ref(counters)),
+        dd::to<std::vector>());
+    CHECK(tagged == std::vector<std::string>{"a1", "b2", "a1", "a1"});
+    CHECK(counters.hits == 2);
+}
+
+} // namespace
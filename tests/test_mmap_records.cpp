@@ -0,0 +1,179 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+#include "descend/mmap_records.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+struct Trade
+{
+    std::int64_t ts;
+    double price;
+    std::uint32_t qty;
+};
+
+struct temp_file
+{
+    std::string path;
+
+    explicit temp_file(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("descend_test_" + name)).string())
+    {}
+
+    ~temp_file()
+    {
+        std::remove(path.c_str());
+    }
+
+    template <class T>
+    void write(const std::vector<T>& records) const
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        REQUIRE(file != nullptr);
+        if (!records.empty()) { // data() of empty vector may be null, which fwrite() doesn't accept
+            REQUIRE(std::fwrite(records.data(), sizeof(T), records.size(), file) == records.size());
+        }
+        std::fclose(file);
+    }
+};
+
+std::vector<Trade> make_trades(const int count)
+{
+    std::vector<Trade> trades;
+    for (int i = 0; i < count; ++i) {
+        trades.push_back({1000 + i * 10, i * 0.5, static_cast<std::uint32_t>(i % 7)});
+    }
+    return trades;
+}
+
+TEST_CASE("mmap_records yields records of the file")
+{
+    const temp_file file{"records.bin"};
+    const auto trades = make_trades(1000);
+    file.write(trades);
+
+    const auto mapped = dd::mmap_records<Trade>(file.path);
+    CHECK(mapped.size() == 1000);
+
+    const auto ts = dd::apply(mapped, dd::transform([] (const Trade& t) { return t.ts; }), dd::to<std::vector>());
+    REQUIRE(ts.size() == 1000);
+    CHECK(ts.capacity() == 1000); // exact size hint
+    CHECK(ts[0] == 1000);
+    CHECK(ts[999] == 1000 + 9990);
+
+    // records are not copied
+    const Trade* first = dd::apply(mapped, dd::transform([] (const Trade& t) { return &t; }), dd::take_n(1), dd::to<std::vector>())[0];
+    CHECK(first == mapped.records().data());
+    static_assert(std::is_same_v<decltype(mapped.records()), std::span<const Trade>>);
+
+    const auto total_qty = dd::apply(dd::mmap_records<Trade>(file.path), dd::transform(&Trade::qty), dd::accumulate(0u));
+    CHECK(total_qty == dd::apply(trades, dd::transform(&Trade::qty), dd::accumulate(0u)));
+}
+
+TEST_CASE("mmap_records yields references only when the mapping outlives the computation")
+{
+    using records_type = dd::mapped_records<Trade>;
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<records_type&>, const Trade&>);
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<const records_type&>, const Trade&>);
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<records_type&&>, const Trade&&>);
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<records_type>, const Trade&&>);
+
+    // where() of an lvalue refers to its mapping, where() of an rvalue owns it
+    using field_type = decltype(&Trade::ts);
+    using referring_type = dd::detail::filtered_records_source<Trade, const records_type*, field_type, std::int64_t>;
+    using owning_type = dd::detail::filtered_records_source<Trade, records_type, field_type, std::int64_t>;
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<referring_type&&>, const Trade&>);
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<owning_type&>, const Trade&>);
+    static_assert(std::is_same_v<dd::detail::iterate_output_t<owning_type&&>, const Trade&&>);
+
+    const temp_file file{"refs.bin"};
+    file.write(make_trades(100));
+    const auto mapped = dd::mmap_records<Trade>(file.path);
+    const auto cheapest = dd::apply(mapped, dd::min_ref([] (const Trade& a, const Trade& b) { return a.price < b.price; }));
+    REQUIRE(cheapest.has_value());
+    CHECK(&cheapest->get() == mapped.records().data());
+
+    // temporary mapping: elements are still passed by reference, but *_ref stages reject them
+    const auto first = dd::apply(dd::mmap_records<Trade>(file.path), dd::transform(&Trade::ts), dd::take_n(1), dd::to<std::vector>());
+    CHECK(first == std::vector<std::int64_t>{1000});
+}
+
+TEST_CASE("mmap_records errors")
+{
+    CHECK_THROWS_AS(dd::mmap_records<Trade>("/nonexistent/descend/records.bin"), std::system_error);
+
+    const temp_file file{"bytes.bin"};
+    file.write(std::vector<char>(sizeof(Trade) + 1));
+    CHECK_THROWS_AS(dd::mmap_records<Trade>(file.path), std::invalid_argument);
+
+    const temp_file empty{"empty.bin"};
+    empty.write(std::vector<Trade>{});
+    const auto mapped = dd::mmap_records<Trade>(empty.path);
+    CHECK(mapped.size() == 0);
+    CHECK(dd::apply(mapped, dd::to<std::vector>()).empty());
+    CHECK(dd::apply(mapped.where(&Trade::ts, 0, 10), dd::to<std::vector>()).empty());
+}
+
+TEST_CASE("mmap_records where() with and without block index")
+{
+    const temp_file file{"indexed.bin"};
+    const temp_file index_file{"indexed.bin.ts"};
+    const auto trades = make_trades(10000); // ts in [1000, 100990], sorted
+    file.write(trades);
+
+    const auto mapped = dd::mmap_records<Trade>(file.path);
+    dd::block_index<std::int64_t>::build(mapped.records(), &Trade::ts, 256).save(index_file.path);
+    const auto index = dd::block_index<std::int64_t>::load(index_file.path);
+    CHECK(index.blocks() == 40);
+    CHECK(index.min(0) == 1000);
+    CHECK(index.max(39) == 100990);
+
+    const auto expected = dd::apply(trades,
+            dd::filter([] (const Trade& t) { return t.ts >= 50000 && t.ts <= 53000; }),
+            dd::transform(&Trade::ts),
+            dd::to<std::vector>());
+    REQUIRE(expected.size() == 301);
+
+    const auto scan = mapped.where(&Trade::ts, 50000, 53000);
+    CHECK(scan.selected_blocks().size() == 1); // no index: all records as one block
+    CHECK(dd::apply(scan, dd::transform(&Trade::ts), dd::to<std::vector>()) == expected);
+
+    const auto indexed = mapped.where(&Trade::ts, 50000, 53000, &index);
+    CHECK(indexed.selected_blocks() == std::vector<std::size_t>{19, 20});
+    CHECK(dd::apply(indexed, dd::transform(&Trade::ts), dd::to<std::vector>()) == expected);
+
+    // ownership of the mapping is moved into the source
+    const auto owning = dd::mmap_records<Trade>(file.path).where(&Trade::ts, 50000, 53000, &index);
+    CHECK(dd::apply(owning, dd::transform(&Trade::ts), dd::to<std::vector>()) == expected);
+
+    CHECK(dd::apply(mapped.where(&Trade::ts, 0, 999, &index), dd::to<std::vector>()).empty());
+    CHECK(mapped.where(&Trade::ts, 0, 999, &index).selected_blocks().empty());
+
+    // projection as a field, early stop
+    const auto price_index = dd::block_index<double>::build(mapped.records(), [] (const Trade& t) { return t.price; }, 1000);
+    const auto cheap = dd::apply(
+        mapped.where([] (const Trade& t) { return t.price; }, 100.0, 1e9, &price_index),
+        dd::take_n(3),
+        dd::transform(&Trade::price),
+        dd::to<std::vector>());
+    CHECK(cheap == std::vector{100.0, 100.5, 101.0});
+
+    const auto other = dd::block_index<std::int64_t>::build(std::span(trades).first(100), &Trade::ts);
+    CHECK_THROWS_AS((void) mapped.where(&Trade::ts, 0, 1, &other), std::invalid_argument);
+    CHECK_THROWS_AS(dd::block_index<double>::load(index_file.path), std::invalid_argument);
+}
+
+} // namespace
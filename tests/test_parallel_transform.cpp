@@ -0,0 +1,135 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+#include "descend/stages/parallel_transform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+TEST_CASE("parallel_transform keeps the order of elements")
+{
+    std::vector<int> input;
+    for (int i = 0; i < 10000; ++i) {
+        input.push_back(i);
+    }
+    const auto caller = std::this_thread::get_id();
+    std::atomic<int> on_caller{0};
+    const auto square = [&] (int x) {
+        if (std::this_thread::get_id() == caller) {
+            ++on_caller;
+        }
+        if (x % 1000 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // slow elements are overtaken by workers
+        }
+        return std::to_string(x * x);
+    };
+
+    bool next_on_caller = true;
+    const auto result = dd::apply(input,
+        dd::parallel_transform(square, 4, 16),
+        dd::transform([&] (std::string s) {
+            next_on_caller = next_on_caller && std::this_thread::get_id() == caller;
+            return s;
+        }),
+        dd::to<std::vector>());
+    CHECK(result == dd::apply(input, dd::transform([] (int x) { return std::to_string(x * x); }), dd::to<std::vector>()));
+    CHECK(result.capacity() == 10000); // size hint is passed through
+    CHECK(on_caller == 0);
+    CHECK(next_on_caller);
+
+    CHECK(dd::apply(std::vector<int>{}, dd::parallel_transform(square, 4), dd::to<std::vector>()).empty());
+}
+
+TEST_CASE("parallel_transform_unordered passes all results")
+{
+    std::vector<std::string> input;
+    for (int i = 0; i < 1000; ++i) {
+        input.push_back(std::to_string(i));
+    }
+    auto result = dd::apply(input,
+        dd::parallel_transform_unordered([] (std::string s) { return std::stoi(s); }, 3),
+        dd::to<std::vector>());
+    std::sort(result.begin(), result.end());
+    REQUIRE(result.size() == 1000);
+    CHECK(result.front() == 0);
+    CHECK(result.back() == 999);
+    CHECK(std::adjacent_find(result.begin(), result.end()) == result.end());
+}
+
+TEST_CASE("parallel_transform stops dispatching when the next stages are done")
+{
+    std::atomic<int> calls{0};
+    const auto twice = [&calls] (int x) { ++calls; return 2 * x; };
+
+    const auto first = dd::apply(dd::iota(0), dd::parallel_transform(twice, 2, 8), dd::take_n(5), dd::to<std::vector>());
+    CHECK(first == std::vector{0, 2, 4, 6, 8});
+    CHECK(calls <= 5 + 8); // at most a window of extra work
+
+    const auto stage = dd::parallel_transform_unordered(twice, 2, 8);
+    CHECK(dd::apply(dd::iota(0), stage, dd::take_n(5), dd::to<std::vector>()).size() == 5);
+    CHECK(dd::apply(dd::iota(0), stage, dd::take_n(7), dd::to<std::vector>()).size() == 7);
+}
+
+TEST_CASE("parallel_transform inside map_group_by shares worker threads between groups")
+{
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    const auto negate = [&] (int x) {
+        {
+            const std::lock_guard lock{mutex};
+            threads.insert(std::this_thread::get_id());
+        }
+        return -x;
+    };
+
+    const auto groups = dd::apply(
+        dd::iota(0, 20000),
+        dd::map_group_by<std::map>([] (int x) { return x % 500; }, dd::parallel_transform(negate, 3, 4), dd::accumulate()),
+        dd::make_pair(),
+        dd::to<std::vector>());
+    REQUIRE(groups.size() == 500);
+    CHECK(groups[0] == std::pair{0, -(0 + 19500) * 40 / 2});
+    CHECK(groups[499] == std::pair{499, -(499 + 19999) * 40 / 2});
+    CHECK(threads.size() <= 3);
+}
+
+TEST_CASE("parallel_transform errors")
+{
+    const auto identity = [] (int x) { return x; };
+    CHECK_THROWS_AS(dd::parallel_transform(identity, 0), std::invalid_argument);
+    CHECK_THROWS_AS(dd::parallel_transform(identity, 2, 0), std::invalid_argument);
+    CHECK_THROWS_AS(dd::parallel_transform_unordered(identity, 0, 4), std::invalid_argument);
+
+    const auto fail = [] (int x) {
+        if (x == 500) {
+            throw std::runtime_error("bad element");
+        }
+        return x;
+    };
+    std::vector<int> input(1000);
+    for (int i = 0; i < 1000; ++i) {
+        input[static_cast<std::size_t>(i)] = i;
+    }
+    std::vector<int> seen;
+    CHECK_THROWS_AS((void) dd::apply(input,
+        dd::parallel_transform(fail, 4),
+        dd::transform([&seen] (int x) { seen.push_back(x); return x; }),
+        dd::to<std::vector>()), std::runtime_error);
+    CHECK(seen.size() == 500); // the exception is rethrown in order
+}
+
+} // namespace
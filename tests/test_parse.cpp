@@ -0,0 +1,131 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+template <class T>
+dd::error_or<T> parse_with_from_chars(const std::string_view str)
+{
+    T value;
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{}) {
+        return dd::error_or<T>{dd::in_place_error, std::make_error_code(ec)};
+    }
+    if (ptr != str.data() + str.size()) {
+        return dd::error_or<T>{dd::in_place_error, std::make_error_code(std::errc::invalid_argument)};
+    }
+    return dd::error_or<T>{dd::in_place_value, value};
+}
+
+template <class T>
+void check_same_as_from_chars(const std::string_view str)
+{
+    CAPTURE(str);
+    const auto expected = parse_with_from_chars<T>(str);
+    const auto actual = dd::parse_number<T>(str);
+    REQUIRE(actual.has_value() == expected.has_value());
+    if (expected.has_value()) {
+        CHECK(actual.value() == expected.value());
+    }
+    else {
+        CHECK(actual.error() == expected.error());
+    }
+}
+
+TEST_CASE("parse_number agrees with std::from_chars")
+{
+    const std::vector<std::string_view> inputs = {
+        "", "-", "+1", " 1", "1 ", "0", "-0", "7", "42", "-42", "00000042", "0000000000000042",
+        "12345678", "123456789", "99999999", "100000000", "1234567890123456", "12345678901234567",
+        "127", "128", "-128", "-129", "255", "256", "32767", "32768", "-32768", "65535", "65536",
+        "2147483647", "2147483648", "-2147483648", "-2147483649", "4294967295", "4294967296",
+        "9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809",
+        "18446744073709551615", "18446744073709551616", "12a4", "1234567/", "12345678:", "a2345678",
+        "1234567812345678", "1234567x12345678", "--1", "1-", "0x10", "1e3", "1.5"};
+
+    for (const auto str : inputs) {
+        check_same_as_from_chars<std::int8_t>(str);
+        check_same_as_from_chars<std::uint8_t>(str);
+        check_same_as_from_chars<std::int16_t>(str);
+        check_same_as_from_chars<std::uint16_t>(str);
+        check_same_as_from_chars<int>(str);
+        check_same_as_from_chars<unsigned>(str);
+        check_same_as_from_chars<std::int64_t>(str);
+        check_same_as_from_chars<std::uint64_t>(str);
+        check_same_as_from_chars<double>(str);
+    }
+
+    std::mt19937_64 rng{7};
+    for (int i = 0; i < 10000; ++i) {
+        const auto value = static_cast<std::int64_t>(rng()) >> (rng() % 64);
+        const std::string str = std::to_string(value);
+        check_same_as_from_chars<std::int64_t>(str);
+        check_same_as_from_chars<std::uint64_t>(str);
+        check_same_as_from_chars<int>(str);
+    }
+}
+
+TEST_CASE("parse composes with unwrap_error_or")
+{
+    const std::vector<std::string> good = {"5", "-6", "00000007"};
+    const auto values = dd::apply(good, dd::parse<int>(), dd::unwrap_error_or(), dd::to<std::vector>());
+    REQUIRE(values.has_value());
+    CHECK(values.value() == std::vector{5, -6, 7});
+
+    const std::list<std::string_view> bad = {"5", "ABC", "7"};
+    const auto error = dd::apply(bad, dd::parse<int>(), dd::unwrap_error_or(), dd::to<std::vector>());
+    REQUIRE(error.has_error());
+    CHECK(error.error() == std::make_error_code(std::errc::invalid_argument));
+
+    const std::vector<const char*> doubles = {"0.5", "-2", "1e3"};
+    const auto sum = dd::apply(doubles, dd::parse<double>(), dd::unwrap_error_or(), dd::accumulate(0.0));
+    REQUIRE(sum.has_value());
+    CHECK(sum.value() == 998.5);
+}
+
+TEST_CASE("parse_batch parses the whole input into error_or<vector>")
+{
+    std::vector<std::string> fields;
+    for (int i = 0; i < 1000; ++i) {
+        fields.push_back(i == 700 ? "70O" : std::to_string(i * 1237));
+    }
+
+    // error in the middle of a block
+    const auto error = dd::apply(fields, dd::parse_batch<std::uint32_t>());
+    REQUIRE(error.has_error());
+    CHECK(error.error() == std::make_error_code(std::errc::invalid_argument));
+
+    fields[700] = std::to_string(700 * 1237);
+    const auto expected = dd::apply(fields, dd::parse<std::uint32_t>(), dd::unwrap_error_or(), dd::to<std::vector>());
+    const auto batched = dd::apply(fields, dd::parse_batch<std::uint32_t>());
+    REQUIRE(batched.has_value());
+    CHECK(batched == expected);
+
+    const std::list<std::string_view> overflow = {"1", "4294967296"};
+    const auto sum = dd::apply(
+        overflow,
+        dd::parse_batch<std::uint32_t>(),
+        dd::unwrap_error_or_complete(),
+        dd::accumulate(std::uint64_t{0}));
+    REQUIRE(sum.has_error());
+    CHECK(sum.error() == std::make_error_code(std::errc::result_out_of_range));
+
+    const std::vector<std::string_view> empty;
+    const auto none = dd::apply(empty, dd::parse_batch<int>());
+    REQUIRE(none.has_value());
+    CHECK(none.value().empty());
+}
+
+} // namespace
@@ -0,0 +1,87 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+struct Record
+{
+    int value;
+};
+
+TEST_CASE("prefetch passes elements through unchanged")
+{
+    std::vector<std::unique_ptr<Record>> storage;
+    std::vector<const Record*> records;
+    for (int i = 0; i < 10; ++i) {
+        storage.push_back(std::make_unique<Record>(Record{i}));
+        records.push_back(storage.back().get());
+    }
+
+    for (const std::size_t distance : {0, 1, 4, 10, 100}) {
+        const auto values = dd::apply(
+            records,
+            dd::prefetch(distance),
+            dd::transform([] (const Record* r) { return r->value; }),
+            dd::to<std::vector>()
+        );
+        CHECK(values == std::vector{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    }
+}
+
+TEST_CASE("prefetch with address function and early stop")
+{
+    const std::vector<int> table = {10, 20, 30, 40, 50};
+    const std::array<std::size_t, 6> indices = {4, 0, 3, 3, 1, 2};
+
+    const auto values = dd::apply(
+        indices,
+        dd::prefetch(2, [&table] (std::size_t i) { return &table[i]; }),
+        dd::transform([&table] (std::size_t i) { return table[i]; }),
+        dd::take_n(4),
+        dd::to<std::vector>()
+    );
+    CHECK(values == std::vector{50, 10, 40, 40});
+}
+
+TEST_CASE("prefetch keeps value category of the input")
+{
+    std::vector<std::string> strings = {"a", "b"};
+
+    dd::apply(std::ref(strings), dd::prefetch(1, [] (const std::string& s) { return s.data(); }),
+              dd::for_each([] (std::string& s) { s += "!"; }));
+    CHECK(strings == std::vector<std::string>{"a!", "b!"});
+
+    const auto moved = dd::apply(
+        std::move(strings),
+        dd::prefetch(1, [] (const std::string& s) { return s.data(); }),
+        dd::transform([] <class S> (S&& s) {
+            static_assert(std::is_same_v<S, std::string>);
+            return std::string{(S&&) s};
+        }),
+        dd::to<std::vector>()
+    );
+    CHECK(moved == std::vector<std::string>{"a!", "b!"});
+}
+
+TEST_CASE("prefetch passes size hint")
+{
+    const std::vector<int> ints(100, 1);
+    std::vector<int> out;
+    std::vector<int>& result = dd::apply(ints, dd::prefetch(8, [] (const int& x) { return &x; }), dd::into(std::ref(out)));
+    CHECK(&result == &out);
+    CHECK(out.capacity() == 100);
+}
+
+} // namespace anonymous
@@ -0,0 +1,94 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+// 0..n-1 in random order
+std::vector<std::int64_t> make_shuffled(const std::int64_t n, const unsigned seed)
+{
+    std::vector<std::int64_t> values(static_cast<std::size_t>(n));
+    for (std::int64_t i = 0; i < n; ++i) {
+        values[static_cast<std::size_t>(i)] = i;
+    }
+    std::shuffle(values.begin(), values.end(), std::mt19937{seed});
+    return values;
+}
+
+TEST_CASE("quantiles of small input are exact")
+{
+    const std::vector<int> values = {5, 1, 4, 2, 3};
+    const auto result = dd::apply(values, dd::quantiles({0.0, 0.2, 0.5, 1.0}));
+    CHECK(result == std::vector<int>{1, 1, 3, 5});
+
+    CHECK(dd::apply(std::vector<double>{}, dd::quantiles({0.5})).empty());
+    CHECK_THROWS_AS((void) dd::quantiles({1.5}), std::invalid_argument);
+    CHECK_THROWS_AS((void) dd::quantiles({0.5}, 0.0), std::invalid_argument);
+}
+
+TEST_CASE("quantiles of large input are within accuracy and memory is bounded")
+{
+    constexpr std::int64_t n = 200'000;
+    const auto values = make_shuffled(n, 1);
+
+    const auto result = dd::apply(values, dd::quantiles({0.5, 0.95, 0.99}));
+    REQUIRE(result.size() == 3);
+    // values are 0..n-1, so the value is its rank
+    CHECK(std::abs(static_cast<double>(result[0]) / n - 0.5) < 0.02);
+    CHECK(std::abs(static_cast<double>(result[1]) / n - 0.95) < 0.02);
+    CHECK(std::abs(static_cast<double>(result[2]) / n - 0.99) < 0.02);
+
+    const auto sketch = dd::apply(values, dd::quantile_sketch());
+    CHECK(sketch.count() == static_cast<std::uint64_t>(n));
+    CHECK(sketch.retained() < 1000);
+    CHECK(sketch.quantile(0.0) == 0);
+    CHECK(sketch.quantile(1.0) == n - 1);
+    CHECK(std::abs(sketch.rank(n / 4) - 0.25) < 0.02);
+}
+
+TEST_CASE("quantile sketches from shards merge")
+{
+    constexpr std::int64_t n = 100'000;
+    const auto values = make_shuffled(n, 2);
+    const std::vector<std::int64_t> first(values.begin(), values.begin() + n / 3);
+    const std::vector<std::int64_t> second(values.begin() + n / 3, values.end());
+
+    auto merged = dd::apply(first, dd::quantile_sketch(0.005));
+    merged.merge(dd::apply(second, dd::quantile_sketch(0.005)));
+    CHECK(merged.count() == static_cast<std::uint64_t>(n));
+
+    const auto median = merged.quantile(0.5);
+    REQUIRE(median.has_value());
+    CHECK(std::abs(static_cast<double>(*median) / n - 0.5) < 0.01);
+
+    CHECK_THROWS_AS(merged.merge(dd::kll_sketch<std::int64_t>{64}), std::invalid_argument);
+}
+
+TEST_CASE("quantiles per group")
+{
+    const auto values = make_shuffled(30'000, 3);
+    const auto groups = dd::apply(
+        values,
+        dd::map_group_by<std::map>([] (std::int64_t x) { return x % 3; }, dd::quantiles({0.5})),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    REQUIRE(groups.size() == 3);
+    for (const auto& [key, result] : groups) {
+        REQUIRE(result.size() == 1);
+        CHECK(std::abs(static_cast<double>(result[0]) / 30'000 - 0.5) < 0.02);
+    }
+}
+
+} // namespace anonymous
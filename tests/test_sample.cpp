@@ -0,0 +1,120 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+std::vector<int> make_ints(const int n)
+{
+    std::vector<int> ints(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        ints[static_cast<std::size_t>(i)] = i;
+    }
+    return ints;
+}
+
+TEST_CASE("sample returns k distinct elements of the input")
+{
+    const auto ints = make_ints(1000);
+
+    const auto result = dd::apply(ints, dd::sample(10, 42));
+    static_assert(std::is_same_v<decltype(result), const std::vector<int>>);
+    REQUIRE(result.size() == 10);
+    CHECK(std::set<int>(result.begin(), result.end()).size() == 10);
+    CHECK(std::all_of(result.begin(), result.end(), [] (int x) { return 0 <= x && x < 1000; }));
+
+    CHECK(dd::apply(ints, dd::sample(10, 42)) == result);
+    CHECK(dd::apply(ints, dd::sample(10, 43)) != result);
+}
+
+TEST_CASE("sample with k not less than size returns all elements")
+{
+    const std::vector<std::string> strings = {"a", "b", "c"};
+    CHECK(dd::apply(strings, dd::sample(3, 1)) == strings);
+    CHECK(dd::apply(strings, dd::sample(5, 1)) == strings);
+    CHECK(dd::apply(strings, dd::sample(0, 1)).empty());
+    CHECK(dd::apply(std::vector<int>{}, dd::sample(3, 1)).empty());
+}
+
+TEST_CASE("sample skip-ahead over random access input matches element by element processing")
+{
+    const auto ints = make_ints(100'000);
+
+    for (const std::size_t k : {1, 7, 100}) {
+        const auto random_access = dd::apply(ints, dd::sample(k, 7));
+        const auto incremental = dd::apply(
+            ints,
+            dd::filter([] (int) { return true; }),
+            dd::sample(k, 7)
+        );
+        CHECK(random_access == incremental);
+    }
+}
+
+TEST_CASE("sample is uniform")
+{
+    constexpr int n = 20;
+    constexpr std::size_t k = 5;
+    constexpr int trials = 4000;
+
+    const auto ints = make_ints(n);
+    std::array<int, n> hits = {};
+    for (int seed = 0; seed < trials; ++seed) {
+        for (const int x : dd::apply(ints, dd::sample(k, static_cast<std::uint64_t>(seed)))) {
+            ++hits[static_cast<std::size_t>(x)];
+        }
+    }
+    // expected trials * k / n = 1000 hits for every element, standard deviation is about 27
+    for (const int h : hits) {
+        CHECK(h > 850);
+        CHECK(h < 1150);
+    }
+}
+
+TEST_CASE("sample_by_key samples every group independently")
+{
+    const auto ints = make_ints(10'000);
+
+    const auto samples = dd::apply(
+        ints,
+        dd::sample_by_key<std::map>([] (int x) { return x % 3; }, 4, 42),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    REQUIRE(samples.size() == 3);
+    for (const auto& [key, sample] : samples) {
+        REQUIRE(sample.size() == 4);
+        CHECK(std::all_of(sample.begin(), sample.end(), [key] (int x) { return x % 3 == key; }));
+    }
+
+    // same positions within groups would give x / 3 equal for all groups
+    const auto positions = [] (std::vector<int> sample) {
+        for (int& x : sample) {
+            x /= 3;
+        }
+        std::sort(sample.begin(), sample.end());
+        return sample;
+    };
+    CHECK(positions(samples[0].second) != positions(samples[1].second));
+
+    const auto again = dd::apply(
+        ints,
+        dd::sample_by_key<std::map>([] (int x) { return x % 3; }, 4, 42),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    CHECK(again == samples);
+}
+
+} // namespace anonymous
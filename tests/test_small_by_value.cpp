@@ -0,0 +1,78 @@
+#include <doctest.h>
+
+// Built as separate executable with DESCEND_PASS_SMALL_BY_VALUE defined, see CMakeLists.txt
+#include "descend/descend.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+static_assert(dd::detail::pass_small_by_value);
+
+template <class Chain, std::size_t I>
+using chain_input_t = typename std::remove_cvref_t<decltype(std::declval<Chain&>().get(dd::detail::index<I>{}))>::input_type;
+
+TEST_CASE("small trivially copyable elements are passed by value")
+{
+    const std::vector<int> ints = {1, 2, 3};
+    const std::vector<std::string> strings = {"a", "b"};
+
+    using ints_chain = decltype(dd::detail::make_chain(ints, dd::enumerate<std::size_t>(), dd::make_pair(), dd::to<std::vector>()));
+    static_assert(std::is_same_v<chain_input_t<ints_chain, 0>, int>);
+    static_assert(std::is_same_v<chain_input_t<ints_chain, 1>, dd::detail::args<std::size_t, int>>);
+
+    using strings_chain = decltype(dd::detail::make_chain(strings, dd::enumerate<std::size_t>(), dd::make_pair(), dd::to<std::vector>()));
+    static_assert(std::is_same_v<chain_input_t<strings_chain, 0>, const std::string&>);
+    static_assert(std::is_same_v<chain_input_t<strings_chain, 1>, dd::detail::args<std::size_t, const std::string&>>);
+
+    const auto result = dd::apply(
+        ints,
+        dd::enumerate<std::size_t>(),
+        dd::filter([] (std::size_t i, int) { return i != 1; }),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    CHECK(result == std::vector<std::pair<std::size_t, int>>{{0, 1}, {2, 3}});
+}
+
+TEST_CASE("non-small and mutable references keep reference semantics")
+{
+    std::vector<int> ints = {1, 2, 3};
+    dd::apply(std::ref(ints), dd::for_each([] (int& x) { x *= 10; }));
+    CHECK(ints == std::vector{10, 20, 30});
+
+    const std::vector<std::string> strings = {"a", "b"};
+    const auto addresses = dd::apply(
+        strings,
+        dd::transform([] (const std::string& s) { return &s; }),
+        dd::to<std::vector>()
+    );
+    CHECK(addresses == std::vector{&strings[0], &strings[1]});
+}
+
+TEST_CASE("higher-order stages with values passed by value")
+{
+    const std::vector<int> ints = {1, 2, 3, 4, 5};
+
+    const auto groups = dd::apply(
+        ints,
+        dd::map_group_by<std::map>([] (int x) { return x % 2; }, dd::accumulate()),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    CHECK(groups == std::vector<std::pair<int, int>>{{0, 6}, {1, 9}});
+
+    const auto [count, max] = dd::apply(ints, dd::tee(dd::count(), dd::max()));
+    CHECK(count == 5);
+    CHECK(max == 5); // std::optional<int>
+}
+
+} // namespace anonymous
@@ -3,9 +3,13 @@
 #include "descend/descend.hpp"
 
 #include <algorithm>
+#include <deque>
 #include <functional>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace {
@@ -67,6 +71,132 @@ TEST_CASE("Max stage finds maximum value")
     CHECK(result == 9);
 }
 
+TEST_CASE("min_ref/max_ref refer to elements of the input range")
+{
+    const std::vector<std::string> words = {"pear", "apple", "zucchini", "fig"};
+
+    auto min = dd::apply(words, dd::min_ref());
+    static_assert(std::is_same_v<decltype(min), std::optional<std::reference_wrapper<const std::string>>>);
+    REQUIRE(min.has_value());
+    CHECK(&min->get() == &words[1]);
+
+    auto max = dd::apply(words, dd::max_ref());
+    REQUIRE(max.has_value());
+    CHECK(&max->get() == &words[2]);
+
+    auto shortest_longest = dd::apply(
+        words,
+        dd::min_max_ref([] (const std::string& a, const std::string& b) { return a.size() < b.size(); })
+    );
+    REQUIRE(shortest_longest.has_value());
+    CHECK(&shortest_longest->min.get() == &words[3]);
+    CHECK(&shortest_longest->max.get() == &words[2]);
+
+    const std::vector<std::string> empty;
+    CHECK_FALSE(dd::apply(empty, dd::max_ref()).has_value());
+}
+
+TEST_CASE("top_k_ref returns k greatest elements without copying")
+{
+    std::vector<int> values = {5, 1, 9, 3, 7, 9, 2};
+
+    auto top3 = dd::apply(std::ref(values), dd::top_k_ref(3));
+    static_assert(std::is_same_v<decltype(top3), std::vector<std::reference_wrapper<const int>>>);
+    REQUIRE(top3.size() == 3);
+    CHECK(top3[0].get() == 9);
+    CHECK(top3[1].get() == 9);
+    CHECK(top3[2].get() == 7);
+    CHECK(&top3[2].get() == &values[4]);
+
+    auto bottom2 = dd::apply(values, dd::top_k_ref(2, std::greater<>{}));
+    REQUIRE(bottom2.size() == 2);
+    CHECK(bottom2[0].get() == 1);
+    CHECK(bottom2[1].get() == 2);
+
+    CHECK(dd::apply(values, dd::top_k_ref(10)).size() == values.size());
+    CHECK(dd::apply(values, dd::top_k_ref(0)).empty());
+}
+
+TEST_CASE("into() reuses caller-owned container")
+{
+    std::vector<int> buffer;
+
+    auto result = dd::apply(
+        std::vector{1, 2, 3, 4, 5},
+        dd::filter([](int x) { return x % 2 == 1; }),
+        dd::into(std::ref(buffer))
+    );
+    static_assert(std::is_same_v<decltype(result), std::reference_wrapper<std::vector<int>>>);
+    CHECK(&result.get() == &buffer);
+    CHECK(buffer == std::vector{1, 3, 5});
+
+    const auto capacity = buffer.capacity();
+    const auto* data = buffer.data();
+    (void) dd::apply(std::vector{7, 9}, dd::into(std::ref(buffer)));
+    CHECK(buffer == std::vector{7, 9});
+    CHECK(buffer.capacity() == capacity);
+    CHECK(buffer.data() == data);
+
+    std::string str = "old content";
+    (void) dd::apply(std::string_view{"hello"}, dd::into(std::ref(str)));
+    CHECK(str == "hello");
+}
+
+TEST_CASE("into() inside tee and group_by")
+{
+    std::vector<int> evens;
+    std::deque<int> odds;
+
+    const auto [evens_ref, odds_ref, count] = dd::apply(
+        dd::iota(0, 7),
+        dd::tee(
+            dd::compose(dd::filter([](int x) { return x % 2 == 0; }), dd::into(std::ref(evens))),
+            dd::compose(dd::filter([](int x) { return x % 2 == 1; }), dd::into(std::ref(odds))),
+            dd::count()
+        )
+    );
+    CHECK(&evens_ref == &evens);
+    CHECK(&odds_ref == &odds);
+    CHECK(evens == std::vector{0, 2, 4, 6});
+    CHECK(odds == std::deque{1, 3, 5});
+    CHECK(count == 7);
+
+    std::vector<int> group;
+    std::vector<std::size_t> sizes;
+    dd::apply(
+        std::vector{1, 1, 2, 3, 3, 3},
+        dd::group_by(std::identity(), dd::into(std::ref(group))),
+        dd::for_each([&sizes](int key, const std::vector<int>& g) {
+            CHECK(std::all_of(g.begin(), g.end(), [key](int x) { return x == key; }));
+            sizes.push_back(g.size());
+        })
+    );
+    CHECK(sizes == std::vector<std::size_t>{2, 1, 3});
+}
+
+TEST_CASE("into() is rejected inside map_group_by")
+{
+    // all groups of map_group_by are alive at once, they would clear and append to the same container
+    std::vector<int> buffer;
+    using into_type = decltype(dd::into(std::ref(buffer)));
+    static_assert(dd::detail::shares_caller_state_v<into_type>);
+    static_assert(dd::detail::shares_caller_state_v<decltype(dd::compose(dd::filter(std::identity()), dd::into(std::ref(buffer))))>);
+    static_assert(dd::detail::shares_caller_state_v<decltype(dd::tee(dd::count(), dd::into(std::ref(buffer))))>);
+    static_assert(dd::detail::shares_caller_state_v<decltype(dd::group_by(std::identity(), dd::into(std::ref(buffer))))>);
+    static_assert(!dd::detail::shares_caller_state_v<decltype(dd::tee(dd::count(), dd::to<std::vector>()))>);
+
+    // per group containers are the way to go there
+    auto result = dd::apply(
+        dd::iota(1, 7),
+        dd::map_group_by<std::map>([](int x) { return x % 2; }, dd::to<std::vector>()),
+        dd::make_pair(),
+        dd::to<std::vector>()
+    );
+    REQUIRE(result.size() == 2);
+    CHECK(result[0] == std::pair{0, std::vector{2, 4, 6}});
+    CHECK(result[1] == std::pair{1, std::vector{1, 3, 5}});
+}
+
 TEST_CASE("Generator with iota produces sequence")
 {
     auto result = dd::apply(
@@ -0,0 +1,127 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+// Exact moments of 0, 1, ..., n-1 shifted by 'offset'
+std::vector<double> make_sequence(const std::size_t n, const double offset)
+{
+    std::vector<double> values;
+    for (std::size_t i = 0; i < n; ++i) {
+        values.push_back(offset + static_cast<double>(i));
+    }
+    return values;
+}
+
+TEST_CASE("stats computes mean and variance, random access and element by element paths agree")
+{
+    // large offset: naive sum of squares loses all precision here
+    const auto values = make_sequence(1001, 1e9);
+    const std::list<double> list(values.begin(), values.end());
+
+    const auto vector_stats = dd::apply(values, dd::stats());
+    const auto list_stats = dd::apply(list, dd::stats());
+
+    // variance of 0..n-1 is (n^2 - 1) / 12
+    const double variance = (1001.0 * 1001.0 - 1.0) / 12.0;
+    for (const auto& s : {vector_stats, list_stats}) {
+        CHECK(s.count() == 1001);
+        CHECK(s.mean() == doctest::Approx(1e9 + 500.0).epsilon(1e-15));
+        CHECK(s.variance() == doctest::Approx(variance).epsilon(1e-12));
+        CHECK(s.sample_variance() == doctest::Approx(variance * 1001.0 / 1000.0).epsilon(1e-12));
+    }
+
+    const auto empty = dd::apply(std::vector<int>{}, dd::stats());
+    CHECK(empty.count() == 0);
+    CHECK(std::isnan(empty.mean()));
+    CHECK(std::isnan(empty.variance()));
+    CHECK(std::isnan(dd::apply(std::vector<int>{5}, dd::stats()).sample_variance()));
+}
+
+TEST_CASE("stats<4> computes skewness and kurtosis and merges shards")
+{
+    // exponential-like skewed data: 1 repeated many times, then a long tail
+    std::vector<int> values;
+    for (int i = 1; i <= 60; ++i) {
+        for (int j = 0; j < 60 / i; ++j) {
+            values.push_back(i);
+        }
+    }
+    const std::vector<int> first(values.begin(), values.begin() + 100);
+    const std::vector<int> second(values.begin() + 100, values.end());
+    const std::list<int> list(values.begin(), values.end());
+
+    const auto all = dd::apply(values, dd::stats<4>());
+    const auto by_one = dd::apply(list, dd::stats<4>());
+    auto merged = dd::apply(first, dd::stats<4>());
+    merged.merge(dd::apply(second, dd::stats<4>()));
+
+    // reference two-pass computation
+    double mean = 0.0;
+    for (const int v : values) {
+        mean += v;
+    }
+    mean /= static_cast<double>(values.size());
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    for (const int v : values) {
+        const double d = v - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+    }
+    const double n = static_cast<double>(values.size());
+    const double skewness = std::sqrt(n) * m3 / std::pow(m2, 1.5);
+    const double kurtosis = n * m4 / (m2 * m2) - 3.0;
+    CHECK(skewness > 1.0);
+
+    for (const auto& s : {all, by_one, merged}) {
+        CHECK(s.count() == values.size());
+        CHECK(s.mean() == doctest::Approx(mean).epsilon(1e-12));
+        CHECK(s.variance() == doctest::Approx(m2 / n).epsilon(1e-12));
+        CHECK(s.skewness() == doctest::Approx(skewness).epsilon(1e-10));
+        CHECK(s.kurtosis() == doctest::Approx(kurtosis).epsilon(1e-10));
+    }
+}
+
+TEST_CASE("sum_precise keeps precision with many values")
+{
+    const std::vector<double> tenths(1'000'003, 0.1);
+    const std::list<double> list(tenths.begin(), tenths.end());
+    const double exact = 100000.3;
+
+    CHECK(std::abs(dd::apply(tenths, dd::sum_precise()) - exact) <= 1e-9);
+    CHECK(std::abs(dd::apply(list, dd::sum_precise()) - exact) <= 1e-9);
+    CHECK(std::abs(dd::apply(tenths, dd::accumulate(0.0)) - exact) > 1e-7);
+
+    // cancellation: 1e100 + 1 - 1e100
+    CHECK(dd::apply(std::vector<double>{1e100, 1.0, -1e100}, dd::sum_precise()) == 1.0);
+    // the same in SIMD lanes, with values both larger and smaller than the running sums
+    std::vector<double> lanes(8, 1.0);
+    lanes.insert(lanes.end(), 8, 1e100);
+    lanes.insert(lanes.end(), 8, 0.5);
+    lanes.insert(lanes.end(), 8, -1e100);
+    CHECK(dd::apply(lanes, dd::sum_precise()) == 12.0);
+    CHECK(dd::apply(std::vector<int>{1, 2, 3}, dd::sum_precise()) == 6.0);
+    CHECK(dd::apply(std::vector<double>{}, dd::sum_precise()) == 0.0);
+}
+
+TEST_CASE("sum_precise over random access but not contiguous input")
+{
+    // deque elements are stored in separate blocks, only contiguous ranges take the SIMD path
+    const std::deque<double> ones(1000, 1.0);
+    CHECK(dd::apply(ones, dd::sum_precise()) == 1000.0);
+
+    const std::deque<double> tenths(1'000'003, 0.1);
+    CHECK(std::abs(dd::apply(tenths, dd::sum_precise()) - 100000.3) <= 1e-9);
+}
+
+} // namespace anonymous
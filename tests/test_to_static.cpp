@@ -0,0 +1,113 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+constexpr int square(const int x) noexcept
+{
+    return x * x;
+}
+
+TEST_CASE("to_array builds lookup table at compile time")
+{
+    constexpr auto squares = dd::apply(
+        dd::iota(0, 8),
+        dd::transform(&square),
+        dd::to_array<8>()
+    );
+    static_assert(std::is_same_v<decltype(squares), const std::pair<std::array<int, 8>, std::size_t>>);
+    static_assert(squares.first == std::array{0, 1, 4, 9, 16, 25, 36, 49});
+    static_assert(squares.second == 8);
+
+    // missing elements are value-initialized, the count tells them apart from received zeros
+    constexpr auto partial = dd::apply(dd::iota(1, 3), dd::to_array<4>());
+    static_assert(partial.first == std::array{1, 2, 0, 0});
+    static_assert(partial.second == 2);
+
+    constexpr auto zeros = dd::apply(std::array{0, 0}, dd::to_array<4>());
+    static_assert(zeros.first == std::array{0, 0, 0, 0});
+    static_assert(zeros.second == 2);
+
+    constexpr auto empty = dd::apply(dd::iota(0, 0), dd::to_array<2>());
+    static_assert(empty.second == 0);
+}
+
+TEST_CASE("to_static collects into inplace_vector at compile time")
+{
+    constexpr auto odd = dd::apply(
+        dd::iota(0, 10),
+        dd::filter([] (int x) { return x % 2 == 1; }),
+        dd::to_static<8>()
+    );
+    static_assert(std::is_same_v<decltype(odd), const dd::inplace_vector<int, 8>>);
+    static_assert(odd.size() == 5);
+    static_assert(odd[0] == 1 && odd[4] == 9);
+}
+
+TEST_CASE("to_static overflow policies")
+{
+    const std::vector<std::string> words = {"a", "b", "c", "d"};
+
+    SUBCASE("truncate keeps first N elements and stops") {
+        int processed = 0;
+        auto result = dd::apply(
+            words,
+            dd::transform([&processed] (const std::string& s) { ++processed; return s; }),
+            dd::to_static<2>(dd::overflow::truncate)
+        );
+        CHECK(result.size() == 2);
+        CHECK(result[0] == "a");
+        CHECK(result[1] == "b");
+        CHECK(processed == 2);
+
+        constexpr auto first3 = dd::apply(dd::iota(0), dd::to_array<3>(dd::overflow::truncate));
+        static_assert(first3.first == std::array{0, 1, 2});
+        static_assert(first3.second == 3);
+    }
+
+    SUBCASE("error returns error_or") {
+        auto ok = dd::apply(words, dd::to_static<4>(dd::overflow::error));
+        static_assert(std::is_same_v<decltype(ok), dd::error_or<dd::inplace_vector<std::string, 4>>>);
+        REQUIRE(ok.has_value());
+        CHECK(ok.value().size() == 4);
+
+        auto overflowed = dd::apply(words, dd::to_static<3>(dd::overflow::error));
+        REQUIRE(overflowed.has_error());
+        CHECK(overflowed.error() == std::make_error_code(std::errc::value_too_large));
+
+        auto short_array = dd::apply(words, dd::to_array<6>(dd::overflow::error));
+        static_assert(std::is_same_v<decltype(short_array), dd::error_or<std::pair<std::array<std::string, 6>, std::size_t>>>);
+        REQUIRE(short_array.has_value());
+        CHECK(short_array.value().second == 4);
+        CHECK(short_array.value().first[3] == "d");
+        CHECK(short_array.value().first[4].empty());
+    }
+}
+
+TEST_CASE("inplace_vector basics")
+{
+    dd::inplace_vector<int, 2> v;
+    CHECK(v.empty());
+    CHECK(v.try_emplace_back(1) != nullptr);
+    CHECK(v.try_emplace_back(2) != nullptr);
+    CHECK(v.full());
+    CHECK(v.try_emplace_back(3) == nullptr);
+    CHECK(v.back() == 2);
+    v.pop_back();
+    CHECK(v.size() == 1);
+    v.clear();
+    CHECK(v.empty());
+}
+
+} // namespace anonymous
@@ -0,0 +1,91 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+// Zipf-like stream: value i appears about n / (i + 1) times, in random order
+std::vector<std::uint32_t> make_skewed(const std::uint32_t distinct, const unsigned seed)
+{
+    std::vector<std::uint32_t> values;
+    for (std::uint32_t i = 0; i < distinct; ++i) {
+        for (std::uint32_t j = 0; j < 10'000 / (i + 1); ++j) {
+            values.push_back(i);
+        }
+    }
+    std::shuffle(values.begin(), values.end(), std::mt19937{seed});
+    return values;
+}
+
+TEST_CASE("top_frequent finds the most frequent elements")
+{
+    const auto values = make_skewed(5'000, 1);
+    const auto top = dd::apply(values, dd::top_frequent(5));
+
+    REQUIRE(top.size() == 5);
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        CHECK(top[i].first == i);
+        // Count-Min never underestimates
+        CHECK(top[i].second >= 10'000 / (i + 1));
+        CHECK(top[i].second <= 10'000 / (i + 1) + 200);
+    }
+}
+
+TEST_CASE("top_frequent with small input and strings")
+{
+    const std::vector<std::string> words = {"b", "a", "b", "c", "b", "a"};
+    const auto top = dd::apply(words, dd::top_frequent(10));
+    REQUIRE(top.size() == 3);
+    CHECK(top[0] == std::pair<std::string, std::uint64_t>{"b", 3});
+    CHECK(top[1] == std::pair<std::string, std::uint64_t>{"a", 2});
+    CHECK(top[2] == std::pair<std::string, std::uint64_t>{"c", 1});
+
+    CHECK(dd::apply(std::vector<int>{}, dd::top_frequent(3)).empty());
+    CHECK(dd::apply(words, dd::top_frequent(0)).empty());
+    CHECK_THROWS_AS((void) dd::top_frequent(3, 1024, 17), std::invalid_argument);
+    CHECK_THROWS_AS((void) dd::top_frequent(3, 0, 4), std::invalid_argument);
+    CHECK_THROWS_AS(dd::count_min_sketch::validate(1024, 0), std::invalid_argument);
+}
+
+TEST_CASE("top_frequent in tee alongside exact aggregates")
+{
+    const auto values = make_skewed(1'000, 2);
+    const auto [count, top] = dd::apply(values, dd::tee(dd::count(), dd::top_frequent(3, 1024, 5)));
+    CHECK(count == values.size());
+    REQUIRE(top.size() == 3);
+    CHECK(top[0].first == 0);
+    CHECK(top[1].first == 1);
+    CHECK(top[2].first == 2);
+}
+
+TEST_CASE("count_min_sketch estimates and merges")
+{
+    dd::count_min_sketch first{1000, 4};
+    CHECK(first.width() == 1024);
+    dd::count_min_sketch second{1024, 4};
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        const std::uint64_t hash = dd::detail::splitmix64::mix(i);
+        first.add_hash(hash, i < 10 ? 100 : 1);
+        second.add_hash(hash);
+    }
+    first.merge(second);
+    CHECK(first.total() == 10 * 100 + 990 + 1000);
+    const std::uint64_t estimate = first.estimate_hash(dd::detail::splitmix64::mix(3));
+    CHECK(estimate >= 101);
+    CHECK(estimate <= 120);
+
+    CHECK_THROWS_AS(first.merge(dd::count_min_sketch{1024, 3}), std::invalid_argument);
+}
+
+} // namespace anonymous
@@ -0,0 +1,94 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+TEST_CASE("transform_batch gives the same results as transform")
+{
+    std::vector<std::size_t> batch_sizes;
+    const auto square = [&batch_sizes] (std::span<const int> in, std::span<long> out) {
+        batch_sizes.push_back(in.size());
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            out[i] = long{in[i]} * in[i];
+        }
+    };
+
+    std::vector<int> input;
+    for (int i = 0; i < 10; ++i) {
+        input.push_back(i);
+    }
+
+    const auto batched = dd::apply(input, dd::transform_batch(4, square), dd::to<std::vector>());
+    static_assert(std::is_same_v<decltype(batched), const std::vector<long>>);
+    CHECK(batched == dd::apply(input, dd::transform([] (int x) { return long{x} * x; }), dd::to<std::vector>()));
+    CHECK(batch_sizes == std::vector<std::size_t>{4, 4, 2}); // the last incomplete batch at the end
+    CHECK(batched.capacity() == 10); // size hint is passed through
+
+    batch_sizes.clear();
+    CHECK(dd::apply(std::vector<int>{}, dd::transform_batch(4, square), dd::to<std::vector>()).empty());
+    CHECK(batch_sizes.empty());
+}
+
+TEST_CASE("transform_batch with explicit output type, filter and rvalue inputs")
+{
+    const auto lengths = [] (auto in, auto out) {
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            out[i] = in[i].size();
+        }
+    };
+    std::vector<std::string> input;
+    for (std::size_t i = 0; i < 20; ++i) {
+        input.emplace_back(i, 'x');
+    }
+    const auto result = dd::apply(std::move(input),
+        dd::filter([] (const std::string& s) { return s.size() % 2 == 1; }),
+        dd::transform_batch<std::size_t>(3, lengths),
+        dd::to<std::vector>());
+    CHECK(result == std::vector<std::size_t>{1, 3, 5, 7, 9, 11, 13, 15, 17, 19});
+}
+
+TEST_CASE("transform_batch respects done() of the next stages")
+{
+    std::size_t processed = 0;
+    const auto twice = [&processed] (std::span<const int> in, std::span<int> out) {
+        processed += in.size();
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            out[i] = in[i] * 2;
+        }
+    };
+
+    const auto first = dd::apply(dd::iota(0), dd::transform_batch(8, twice), dd::take_n(5), dd::to<std::vector>());
+    CHECK(first == std::vector{0, 2, 4, 6, 8});
+    CHECK(processed == 8); // infinite input is stopped after the first batch
+
+    processed = 0;
+    const auto limited = dd::apply(dd::iota(0), dd::take_n(11), dd::transform_batch(8, twice), dd::to<std::vector>());
+    CHECK(limited.size() == 11);
+    CHECK(limited.back() == 20);
+    CHECK(processed == 11);
+}
+
+TEST_CASE("transform_batch errors")
+{
+    const auto copy = [] (std::span<const int> in, std::span<int> out) { std::copy(in.begin(), in.end(), out.begin()); };
+    CHECK_THROWS_AS(dd::transform_batch(0, copy), std::invalid_argument);
+
+    // the same stage object can be used in several chains
+    const auto stage = dd::transform_batch(2, copy);
+    CHECK(dd::apply(std::vector{1, 2, 3}, stage, dd::to<std::vector>()) == std::vector{1, 2, 3});
+    CHECK(dd::apply(std::vector{4, 5}, stage, dd::to<std::vector>()) == std::vector{4, 5});
+}
+
+} // namespace
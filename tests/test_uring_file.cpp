@@ -0,0 +1,125 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+#include "descend/uring_file.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+namespace dd = descend;
+
+struct temp_file
+{
+    std::string path;
+
+    explicit temp_file(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("descend_test_" + name)).string())
+    {}
+
+    ~temp_file()
+    {
+        std::remove(path.c_str());
+    }
+
+    void write(const std::string& content) const
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        REQUIRE(file != nullptr);
+        REQUIRE(std::fwrite(content.data(), 1, content.size(), file) == content.size());
+        std::fclose(file);
+    }
+};
+
+std::string make_content(const std::size_t size)
+{
+    std::string content;
+    for (std::size_t i = 0; content.size() < size; ++i) {
+        content += "line " + std::to_string(i) + "\n";
+    }
+    content.resize(size);
+    return content;
+}
+
+std::vector<dd::read_backend> backends()
+{
+    std::vector<dd::read_backend> result{dd::read_backend::automatic, dd::read_backend::pread_thread};
+    if (dd::uring_file_source::io_uring_available()) {
+        result.push_back(dd::read_backend::io_uring);
+    }
+    return result;
+}
+
+const auto to_string = [] (std::span<const std::byte> block) {
+    return std::string(reinterpret_cast<const char*>(block.data()), block.size());
+};
+
+TEST_CASE("uring_file yields blocks of the file in order")
+{
+    const temp_file file{"uring.txt"};
+    const std::string content = make_content(100'000);
+    file.write(content);
+
+    for (const auto backend : backends()) {
+        CAPTURE(static_cast<int>(backend));
+        const auto source = dd::uring_file(file.path, 4096, 4, backend);
+        CHECK(source.file_size() == 100'000);
+        CHECK(source.size() == 25);
+
+        const auto blocks = dd::apply(source, dd::transform(to_string), dd::to<std::vector>());
+        REQUIRE(blocks.size() == 25);
+        CHECK(blocks.capacity() == 25); // exact size hint
+        CHECK(blocks[0].size() == 4096);
+        CHECK(blocks[24].size() == 100'000 - 24 * 4096);
+
+        std::string joined;
+        for (const auto& block : blocks) {
+            joined += block;
+        }
+        CHECK(joined == content);
+
+        // the source can be iterated again, queue deeper than the file
+        CHECK(dd::apply(dd::uring_file(file.path, 65536, 16, backend), dd::transform(to_string), dd::accumulate(std::string{})) == content);
+    }
+}
+
+TEST_CASE("uring_file stops reading when the chain is done")
+{
+    const temp_file file{"uring_large.txt"};
+    const std::string content = make_content(1'000'000);
+    file.write(content);
+
+    for (const auto backend : backends()) {
+        CAPTURE(static_cast<int>(backend));
+        const auto first = dd::apply(dd::uring_file(file.path, 1000, 32, backend),
+            dd::transform(to_string),
+            dd::take_n(3),
+            dd::to<std::vector>());
+        REQUIRE(first.size() == 3);
+        CHECK(first[0] + first[1] + first[2] == content.substr(0, 3000));
+    }
+}
+
+TEST_CASE("uring_file empty file and errors")
+{
+    const temp_file empty{"uring_empty.txt"};
+    empty.write("");
+    for (const auto backend : backends()) {
+        const auto source = dd::uring_file(empty.path, 4096, 4, backend);
+        CHECK(source.size() == 0);
+        CHECK(dd::apply(source, dd::to<std::vector>()).empty());
+    }
+
+    CHECK_THROWS_AS(dd::uring_file("/nonexistent/descend/file.txt"), std::system_error);
+    CHECK_THROWS_AS(dd::uring_file(empty.path, 0), std::invalid_argument);
+    CHECK_THROWS_AS(dd::uring_file(empty.path, 4096, 0), std::invalid_argument);
+}
+
+} // namespace
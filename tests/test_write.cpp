@@ -0,0 +1,157 @@
+#include <doctest.h>
+
+#include "descend/descend.hpp"
+#include "descend/mmap_records.hpp"
+#include "descend/stages/write.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+namespace dd = descend;
+
+struct Point
+{
+    std::int32_t x;
+    double y;
+};
+
+struct temp_path
+{
+    std::string path;
+
+    explicit temp_path(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("descend_test_" + name)).string())
+    {}
+
+    ~temp_path()
+    {
+        std::remove(path.c_str());
+    }
+
+    std::string read() const
+    {
+        std::ifstream in(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+};
+
+TEST_CASE("write_lines formats values into a file")
+{
+    const temp_path file{"lines.txt"};
+
+    const std::vector<int> values = {1, -20, 300};
+    const auto result = dd::apply(values, dd::write_lines(file.path));
+    CHECK(file.read() == "1\n-20\n300\n");
+    CHECK(result == dd::write_result{10, 3});
+
+    // multiple arguments, strings, floating point, bool and char; file is truncated
+    const std::vector<std::string> names = {"a", "bb"};
+    const auto multi = dd::apply(
+        names,
+        dd::enumerate<int>(),
+        dd::zip_result([] (int i, const std::string&) { return i * 0.5; }),
+        dd::zip_result([] (int i, const std::string&, double) { return i == 0; }),
+        dd::zip_result([] (int, const std::string&, double, bool) { return 'z'; }),
+        dd::write_lines(file.path, {.separator = '\t'}));
+    CHECK(file.read() == "0\ta\t0\ttrue\tz\n1\tbb\t0.5\tfalse\tz\n");
+    CHECK(multi.records == 2);
+    CHECK(multi.bytes == file.read().size());
+}
+
+TEST_CASE("write_lines with small buffer, large strings and direct output")
+{
+    const temp_path file{"large.txt"};
+
+    std::vector<std::string> lines;
+    std::ostringstream expected;
+    for (int i = 0; i < 2000; ++i) {
+        lines.push_back(std::string(static_cast<std::size_t>(i % 7 == 0 ? 10000 : i % 50), static_cast<char>('a' + i % 26)));
+        expected << lines.back() << '\n';
+    }
+
+    for (const bool direct : {false, true}) {
+        const auto result = dd::apply(lines, dd::write_lines(file.path, {.buffer_size = 100, .direct = direct}));
+        CHECK(file.read() == expected.str());
+        CHECK(result == dd::write_result{expected.str().size(), lines.size()});
+    }
+}
+
+TEST_CASE("write_lines into file descriptor doesn't close it")
+{
+    const temp_path file{"fd.txt"};
+    const int fd = ::open(file.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+
+    (void) dd::apply(std::vector{1, 2}, dd::write_lines(fd));
+    (void) dd::apply(std::vector{3}, dd::write_lines(fd));
+    CHECK(::close(fd) == 0);
+    CHECK(file.read() == "1\n2\n3\n");
+
+    CHECK_THROWS_AS((void) dd::apply(std::vector{1}, dd::write_lines("/nonexistent/descend/out.txt")), std::system_error);
+}
+
+TEST_CASE("write_lines inside map_group_by and group_by writes all groups into one file")
+{
+    const temp_path file{"groups.txt"};
+    const std::vector<int> values = {1, 2, 3, 4, 5, 6};
+
+    // the file is opened once with the stage, new groups don't truncate it
+    const auto grouped = dd::apply(
+        values,
+        dd::map_group_by<std::map>([] (int x) { return x % 2; }, dd::write_lines(file.path)),
+        dd::make_pair(),
+        dd::to<std::vector>());
+    CHECK(file.read() == "1\n2\n3\n4\n5\n6\n"); // groups share the buffer, lines keep input order
+    REQUIRE(grouped.size() == 2);
+    CHECK(grouped[0] == std::pair{0, dd::write_result{6, 3}});
+    CHECK(grouped[1] == std::pair{1, dd::write_result{6, 3}});
+
+    const auto runs = dd::apply(
+        std::vector{7, 7, 8, 9, 9, 9},
+        dd::group_by(std::identity(), dd::write_records<int>(file.path)),
+        dd::make_pair(),
+        dd::to<std::vector>());
+    REQUIRE(runs.size() == 3);
+    CHECK(runs[2] == std::pair{9, dd::write_result{3 * sizeof(int), 3}});
+    const auto read = dd::apply(dd::mmap_records<int>(file.path), dd::to<std::vector>());
+    CHECK(read == std::vector{7, 7, 8, 9, 9, 9});
+}
+
+TEST_CASE("write_records round trip with mmap_records")
+{
+    const temp_path file{"points.bin"};
+
+    std::vector<Point> points;
+    for (int i = 0; i < 10000; ++i) {
+        points.push_back({i, i * 0.25});
+    }
+
+    for (const bool direct : {false, true}) {
+        const auto result = dd::apply(points, dd::write_records<Point>(file.path, {.direct = direct}));
+        CHECK(result == dd::write_result{points.size() * sizeof(Point), points.size()});
+
+        const auto read = dd::apply(
+            dd::mmap_records<Point>(file.path),
+            dd::filter([] (const Point& p) { return p.x % 1000 == 999; }),
+            dd::transform(&Point::y),
+            dd::to<std::vector>());
+        CHECK(read == std::vector{249.75, 499.75, 749.75, 999.75, 1249.75, 1499.75, 1749.75, 1999.75, 2249.75, 2499.75});
+    }
+}
+
+} // namespace